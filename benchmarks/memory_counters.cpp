@@ -0,0 +1,98 @@
+/*
+ * This file is part of Sqlite3Utils.
+ *
+ * Sqlite3Utils is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Sqlite3Utils is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Sqlite3Utils.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <sys/resource.h>
+#include "memory_counters.hpp"
+
+/* Every allocation of the program, the library included, goes through these operators */
+
+static std::atomic<uint64_t> allocations(0);
+static std::atomic<uint64_t> allocated_bytes(0);
+
+static void *countedAlloc(std::size_t size){
+		void *memory;
+
+		allocations.fetch_add(1, std::memory_order_relaxed);
+		allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+		memory = std::malloc((size == 0) ? 1 : size);
+		if (memory == NULL)
+				throw std::bad_alloc();
+		return memory;
+}
+
+void *operator new(std::size_t size){
+		return countedAlloc(size);
+}
+
+void *operator new[](std::size_t size){
+		return countedAlloc(size);
+}
+
+void operator delete(void *memory) noexcept {
+		std::free(memory);
+}
+
+void operator delete[](void *memory) noexcept {
+		std::free(memory);
+}
+
+void operator delete(void *memory, std::size_t) noexcept {
+		std::free(memory);
+}
+
+void operator delete[](void *memory, std::size_t) noexcept {
+		std::free(memory);
+}
+
+/******************************memorySnapshot**********************************/
+bench::MemorySnapshot bench::memorySnapshot(){
+		MemorySnapshot snapshot;
+
+		snapshot.allocations = allocations.load(std::memory_order_relaxed);
+		snapshot.bytes = allocated_bytes.load(std::memory_order_relaxed);
+		return snapshot;
+}
+
+/******************************peakRssKb***************************************/
+long bench::peakRssKb(){
+		struct rusage usage;
+
+		if (getrusage(RUSAGE_SELF, &usage) != 0)
+				return 0;
+		/* Linux reports KiB, macOS bytes */
+#ifdef __APPLE__
+		return usage.ru_maxrss / 1024;
+#else
+		return usage.ru_maxrss;
+#endif
+}
+
+/******************************reportMemory************************************/
+void bench::reportMemory(benchmark::State &state, const MemorySnapshot &start){
+		MemorySnapshot end = memorySnapshot();
+
+		state.counters["allocs"] = benchmark::Counter(end.allocations - start.allocations, \
+		                                              benchmark::Counter::kAvgIterations);
+		state.counters["alloc_bytes"] = benchmark::Counter(end.bytes - start.bytes, \
+		                                                   benchmark::Counter::kAvgIterations, \
+		                                                   benchmark::Counter::kIs1024);
+		state.counters["peak_rss_kb"] = benchmark::Counter(peakRssKb());
+}
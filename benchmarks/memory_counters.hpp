@@ -0,0 +1,56 @@
+/*
+ * This file is part of Sqlite3Utils.
+ *
+ * Sqlite3Utils is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Sqlite3Utils is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Sqlite3Utils.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef SQLITE3BENCHMEMORY_H
+#define SQLITE3BENCHMEMORY_H
+
+#include <benchmark/benchmark.h>
+#include <cstdint>
+
+namespace bench {
+
+/*!
+ * \brief Allocations done through operator new since the program started.
+ */
+struct MemorySnapshot {
+		uint64_t allocations = 0;/*!< Number of calls to operator new.*/
+		uint64_t bytes = 0;/*!< Bytes requested to operator new.*/
+};
+
+/*!
+ * \brief Get the allocations done so far by every thread of the program.
+ */
+MemorySnapshot memorySnapshot();
+
+/*!
+ * \brief Get the peak resident set size of the process, in KiB.
+ */
+long peakRssKb();
+
+/*!
+ * \brief Add the allocations per iteration done since the snapshot given, and the peak resident
+ *  set size, to the counters of a benchmark.
+ *
+ * @param state Benchmark whose loop just ended.
+ * @param start Snapshot taken right before the loop.
+ */
+void reportMemory(benchmark::State &state, const MemorySnapshot &start);
+
+} // namespace bench
+
+#endif // SQLITE3BENCHMEMORY_H
@@ -0,0 +1,72 @@
+/*
+ * This file is part of Sqlite3Utils.
+ *
+ * Sqlite3Utils is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Sqlite3Utils is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Sqlite3Utils.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <benchmark/benchmark.h>
+#include <cstdio>
+#include "../include/handler.hpp"
+
+/* Full scans of the same table read through pread (mmap size 0) and through memory mapping */
+
+static const char *mmap_db = "BenchMmapDB.db";
+static const int mmap_rows = 100000;
+
+/* Create the scanned table once for every benchmark of the file */
+static void createScanTable(){
+		static bool created = false;
+
+		if (created)
+				return;
+
+		std::remove(mmap_db);
+		handler::Sqlite3Db db(mmap_db);
+		db.executeQuery("CREATE TABLE DATA (ID INTEGER PRIMARY KEY, VALUE REAL, NAME TEXT);");
+		db.executeQuery(("WITH RECURSIVE C(X) AS (SELECT 1 UNION ALL SELECT X + 1 FROM C WHERE X < " + \
+		                 std::to_string(mmap_rows) + ") INSERT INTO DATA SELECT X, X * 0.5, printf('%0200d', X) FROM C;").c_str());
+		created = true;
+}
+
+static void BM_ScanTable(benchmark::State &state){
+		createScanTable();
+
+		/* A small page cache makes every scan go to the file instead of the cached pages */
+		handler::OpenOptions options;
+		options.cache_size = 16;
+		options.mmap_size = state.range(0);
+		options.count_io = true;
+		handler::Sqlite3Db db(mmap_db, options);
+		handler::IoStats stats;
+		int64_t bytes = 0;
+		double sum = 0;
+
+		db.resetIoStats();
+		for (auto _ : state) {
+				db.forEachRow("SELECT VALUE, NAME FROM DATA;", [&](const handler::RowView &row) {
+						sum += row.getDouble(0);
+						bytes += row.getText(1).size();
+						return true;
+				});
+				benchmark::DoNotOptimize(sum);
+		}
+
+		stats = db.getIoStats();
+		state.SetBytesProcessed(bytes);
+		state.SetItemsProcessed(state.iterations() * mmap_rows);
+		state.counters["preads"] = benchmark::Counter(stats.reads, benchmark::Counter::kAvgIterations);
+		state.counters["mmap_hits"] = benchmark::Counter(stats.fetch_hits, benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(BM_ScanTable)->ArgName("mmap_size")->Arg(0)->Arg(256 * 1024 * 1024);
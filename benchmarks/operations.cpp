@@ -0,0 +1,230 @@
+/*
+ * This file is part of Sqlite3Utils.
+ *
+ * Sqlite3Utils is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Sqlite3Utils is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Sqlite3Utils.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <benchmark/benchmark.h>
+#include <cstdio>
+#include <memory>
+#include "../include/handler.hpp"
+#include "../include/query.hpp"
+#include "memory_counters.hpp"
+
+/* Operations of Sqlite3Db on tables of several sizes, stored on disk or in memory.
+ * The first argument of each benchmark is the number of rows, the second one is 1 for a
+ * database file and 0 for ":memory:". */
+
+static const char *ops_db = "BenchOpsDB.db";
+static const std::string ops_table = "CONNECTIONS";
+static const std::vector<handler::FieldDescription> ops_definition = \
+{{"ID", query::data::int_ + query::data::primary_key + query::data::not_null}, \
+		{"AGE", query::data::int_ + query::data::not_null}, \
+		{"PHONE", query::data::int_ + query::data::null}, \
+		{"NAME", query::data::char_ + query::data::len(50) + query::data::not_null}};
+
+/* Open a new database with the table filled with the rows given */
+static std::unique_ptr<handler::Sqlite3Db> openFilledDb(int64_t rows, bool on_disk){
+		std::remove(ops_db);
+		std::unique_ptr<handler::Sqlite3Db> db(new handler::Sqlite3Db(on_disk ? ops_db : ":memory:"));
+
+		db->createTable(ops_table, ops_definition);
+		db->executeQuery(("WITH RECURSIVE C(X) AS (SELECT 1 UNION ALL SELECT X + 1 FROM C WHERE X < " + \
+		                  std::to_string(rows) + ") INSERT INTO " + ops_table + \
+		                  " SELECT X, X % 100, 600000000 + X, 'NAME' || X FROM C;").c_str());
+		return db;
+}
+
+static void sizesAndStorage(benchmark::internal::Benchmark *benchmark){
+		benchmark->ArgNames({"rows", "disk"})->ArgsProduct({{100, 10000, 100000}, {0, 1}});
+}
+
+static void BM_InsertRecord(benchmark::State &state){
+		auto db = openFilledDb(state.range(0), state.range(1));
+		int64_t id = state.range(0);
+		bench::MemorySnapshot start = bench::memorySnapshot();
+
+		for (auto _ : state) {
+				std::string key = std::to_string(++id);
+				benchmark::DoNotOptimize(db->insertRecord(ops_table, {key, "30", "600000000", "NAME" + key}));
+		}
+
+		bench::reportMemory(state, start);
+		state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_InsertRecord)->Apply(sizesAndStorage);
+
+static void BM_SelectRecords(benchmark::State &state){
+		auto db = openFilledDb(state.range(0), state.range(1));
+		size_t values = 0;
+		bench::MemorySnapshot start = bench::memorySnapshot();
+
+		for (auto _ : state) {
+				std::vector<std::string> data = db->selectRecords(ops_table, {"ID", "NAME"}, false, "AGE = 42");
+				values += data.size();
+				benchmark::DoNotOptimize(data.data());
+		}
+
+		bench::reportMemory(state, start);
+		state.SetItemsProcessed(state.iterations());
+		state.counters["values"] = benchmark::Counter(values, benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(BM_SelectRecords)->Apply(sizesAndStorage);
+
+static void BM_SelectRecordsStruct(benchmark::State &state){
+		auto db = openFilledDb(state.range(0), state.range(1));
+		handler::select_query_param select_options;
+		size_t values = 0;
+
+		select_options.table_name = ops_table;
+		select_options.fields = {"ID", "NAME"};
+		select_options.where_cond = "AGE = 42";
+
+		bench::MemorySnapshot start = bench::memorySnapshot();
+		for (auto _ : state) {
+				std::vector<std::string> data = db->selectRecords(select_options);
+				values += data.size();
+				benchmark::DoNotOptimize(data.data());
+		}
+
+		bench::reportMemory(state, start);
+		state.SetItemsProcessed(state.iterations());
+		state.counters["values"] = benchmark::Counter(values, benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(BM_SelectRecordsStruct)->Apply(sizesAndStorage);
+
+static void BM_UpdateTable(benchmark::State &state){
+		auto db = openFilledDb(state.range(0), state.range(1));
+		int64_t id = 0;
+		bench::MemorySnapshot start = bench::memorySnapshot();
+
+		for (auto _ : state) {
+				id = id % state.range(0) + 1;
+				benchmark::DoNotOptimize(db->updateTable(ops_table, {{"AGE", "7"}}, "ID = " + std::to_string(id)));
+		}
+
+		bench::reportMemory(state, start);
+		state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_UpdateTable)->Apply(sizesAndStorage);
+
+static void BM_DeleteRecords(benchmark::State &state){
+		auto db = openFilledDb(state.range(0), state.range(1));
+		int64_t id = 0;
+		uint64_t allocations = 0, bytes = 0;
+
+		for (auto _ : state) {
+				std::string key = std::to_string(id = id % state.range(0) + 1);
+				bench::MemorySnapshot before = bench::memorySnapshot();
+
+				benchmark::DoNotOptimize(db->deleteRecords(ops_table, "ID = " + key));
+
+				bench::MemorySnapshot after = bench::memorySnapshot();
+				allocations += after.allocations - before.allocations;
+				bytes += after.bytes - before.bytes;
+
+				/* Put the row back so the table keeps its size */
+				state.PauseTiming();
+				db->executeQuery(("INSERT INTO " + ops_table + " VALUES (" + key + ", 1, 2, 'NAME');").c_str());
+				state.ResumeTiming();
+		}
+
+		state.SetItemsProcessed(state.iterations());
+		state.counters["allocs"] = benchmark::Counter(allocations, benchmark::Counter::kAvgIterations);
+		state.counters["alloc_bytes"] = benchmark::Counter(bytes, benchmark::Counter::kAvgIterations, \
+		                                                   benchmark::Counter::kIs1024);
+		state.counters["peak_rss_kb"] = benchmark::Counter(bench::peakRssKb());
+}
+BENCHMARK(BM_DeleteRecords)->Apply(sizesAndStorage);
+
+static void BM_ExecuteQuery(benchmark::State &state){
+		auto db = openFilledDb(state.range(0), state.range(1));
+		std::string sql = "SELECT COUNT(*), SUM(PHONE) FROM " + ops_table + " WHERE AGE < 50;";
+		std::vector<std::string> data;
+		bench::MemorySnapshot start = bench::memorySnapshot();
+
+		for (auto _ : state) {
+				data.clear();
+				benchmark::DoNotOptimize(db->executeQuery(sql.c_str(), data, {0, 1}));
+		}
+
+		bench::reportMemory(state, start);
+		state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ExecuteQuery)->Apply(sizesAndStorage);
+
+/* Reload of the schema with tables of the number of columns given, more than the statement
+ * cache holds in the last runs. With changed set, a table is created or dropped before each
+ * update, out of the timing, so the catalog is loaded again every time instead of skipped by
+ * its schema version */
+static void BM_UpdateHandler(benchmark::State &state){
+		std::remove(ops_db);
+		handler::Sqlite3Db db(state.range(1) ? ops_db : ":memory:");
+		std::vector<handler::FieldDescription> fields;
+		static const char *types[] = {"INTEGER", "REAL", "TEXT", "BLOB", "VARCHAR(20)", "DOUBLE", "NUMERIC", "BIGINT"};
+
+		for (int64_t i = 0; i < state.range(0); ++i)
+				fields.push_back({"FIELD" + std::to_string(i), types[i % 8]});
+		for (int64_t i = 0; i < state.range(3); ++i)
+				db.createTable("WIDE" + std::to_string(i), fields);
+
+		bench::MemorySnapshot start = bench::memorySnapshot();
+		bool created = false;
+		for (auto _ : state) {
+				if (state.range(2)) {
+						state.PauseTiming();
+						db.executeQuery(created ? "DROP TABLE CHANGED;" : "CREATE TABLE CHANGED (A INT);");
+						created = !created;
+						state.ResumeTiming();
+				}
+				benchmark::DoNotOptimize(db.updateHandler());
+		}
+
+		bench::reportMemory(state, start);
+		state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_UpdateHandler)->ArgNames({"columns", "disk", "changed", "tables"})->ArgsProduct({{16, 64, 256}, {0, 1}, {0, 1}, {10}});
+BENCHMARK(BM_UpdateHandler)->ArgNames({"columns", "disk", "changed", "tables"})->ArgsProduct({{8, 16}, {0}, {1}, {200, 500}});
+
+static void BM_GetAffinity(benchmark::State &state){
+		static const std::vector<std::string> types = {"INTEGER", "BIGINT", "VARCHAR(255)", "CLOB", "BLOB", \
+		                                               "REAL", "DOUBLE PRECISION", "FLOAT", "NUMERIC", "DECIMAL(10,5)"};
+		bench::MemorySnapshot start = bench::memorySnapshot();
+
+		for (auto _ : state) {
+				for (const std::string &type : types)
+						benchmark::DoNotOptimize(handler::Sqlite3Db::getAffinity(type));
+		}
+
+		bench::reportMemory(state, start);
+		state.SetItemsProcessed(state.iterations() * types.size());
+}
+BENCHMARK(BM_GetAffinity);
+
+static void BM_IsAffined(benchmark::State &state){
+		static const std::vector<std::pair<std::string, std::string> > values = \
+		{{"INTEGER", "123456"}, {"INTEGER", "12a"}, {"REAL", "3.14159"}, {"REAL", "-2,5"}, \
+		 {"NUMERIC", "42"}, {"TEXT", "some text"}, {"BLOB", "x'00FF'"}, {"INTEGER", "NULL"}};
+		bench::MemorySnapshot start = bench::memorySnapshot();
+
+		for (auto _ : state) {
+				for (const auto &value : values)
+						benchmark::DoNotOptimize(handler::Sqlite3Db::isAffined(value.first, value.second));
+		}
+
+		bench::reportMemory(state, start);
+		state.SetItemsProcessed(state.iterations() * values.size());
+}
+BENCHMARK(BM_IsAffined);
@@ -0,0 +1,92 @@
+/*
+ * This file is part of Sqlite3Utils.
+ *
+ * Sqlite3Utils is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Sqlite3Utils is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Sqlite3Utils.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <algorithm>
+#include <benchmark/benchmark.h>
+#include "../include/handler.hpp"
+#include "../include/numeric_validation.hpp"
+#include "../include/query.hpp"
+
+/* Validation of a column of integers, one value at a time as isAffined() did before the
+ * bulk checks, against validateColumn() with each instruction set. The first argument is
+ * the length of the values. */
+
+static const size_t column_values = 100000;
+
+static std::vector<std::string> makeColumn(size_t length){
+		std::vector<std::string> values(column_values);
+
+		for (size_t i = 0; i < values.size(); ++i) {
+				values[i].resize(length);
+				for (size_t c = 0; c < length; ++c)
+						values[i][c] = static_cast<char>('0' + (i + c) % 10);
+		}
+		return values;
+}
+
+/* Per character check, as isAffined() and isValidInt() were written */
+static bool perCharacterIsAffined(const std::string affinity, const std::string value_to_check){
+		if (affinity == query::affinity::integer)
+				return !value_to_check.empty() && \
+				       std::find_if(value_to_check.begin(), value_to_check.end(), \
+				                    handler::Sqlite3Db::isInt) == value_to_check.end();
+		if (affinity == query::affinity::real || affinity == query::affinity::numeric)
+				return !value_to_check.empty() && \
+				       std::find_if(value_to_check.begin(), value_to_check.end(), \
+				                    handler::Sqlite3Db::isReal) == value_to_check.end();
+		return true;
+}
+
+static void BM_ValidatePerCharacter(benchmark::State &state){
+		std::vector<std::string> values = makeColumn(state.range(0));
+
+		for (auto _ : state) {
+				size_t invalid = 0;
+
+				for (const std::string &value : values)
+						invalid += !perCharacterIsAffined(query::affinity::integer, value);
+				benchmark::DoNotOptimize(invalid);
+		}
+
+		state.SetItemsProcessed(state.iterations() * values.size());
+		state.SetBytesProcessed(state.iterations() * values.size() * state.range(0));
+}
+BENCHMARK(BM_ValidatePerCharacter)->ArgName("length")->Arg(8)->Arg(19)->Arg(64)->Arg(256);
+
+/* The second argument is the SimdLevel: 0 scalar, 1 SSE2, 2 AVX2 */
+static void BM_ValidateColumn(benchmark::State &state){
+		std::vector<std::string> values = makeColumn(state.range(0));
+		std::vector<size_t> invalid;
+		handler::SimdLevel previous = handler::validation::getSimdLevel();
+		handler::SimdLevel level = static_cast<handler::SimdLevel>(state.range(1));
+
+		if (handler::validation::setSimdLevel(level) != level) {
+				handler::validation::setSimdLevel(previous);
+				state.SkipWithError("Instruction set not supported by this processor");
+				return;
+		}
+
+		for (auto _ : state) {
+				benchmark::DoNotOptimize(handler::validation::validateColumn(query::affinity::integer, values, invalid));
+		}
+
+		handler::validation::setSimdLevel(previous);
+		state.SetItemsProcessed(state.iterations() * values.size());
+		state.SetBytesProcessed(state.iterations() * values.size() * state.range(0));
+}
+BENCHMARK(BM_ValidateColumn)->ArgNames({"length", "simd"})->ArgsProduct({{8, 19, 64, 256}, {0, 1, 2}});
@@ -0,0 +1,35 @@
+#include <async.hpp>
+#include <handler.hpp>
+
+int main(int argc, char const *argv[]) {
+		//The worker opens its own connection, with up to 128 operations waiting for it
+		handler::AsyncSqlite3Db AsyncHandler("mydatabase.db", 128);
+
+		//Every call returns at once, the operations run in order on the worker
+		std::future<bool> inserted = AsyncHandler.insertRecord("CONNECTIONS", {"1", "25", "555123", "Alice"});
+		std::future<handler::QueryResult> ages = AsyncHandler.executeQuery("SELECT AGE FROM CONNECTIONS;", {0});
+		...
+
+		//The results are moved to the caller once they are ready
+		if (inserted.get() == EXIT_SUCCESS) {
+				handler::QueryResult result = ages.get();
+				...
+		}
+
+		//Any other operation can run on the handler of the worker
+		std::future<handler::ResultSet> rows = AsyncHandler.submit([](handler::Sqlite3Db &db) {
+				handler::ResultSet result;
+				db.executeQuery("SELECT * FROM CONNECTIONS;", result);
+				return result;
+		});
+
+		//Event loops that must never block can skip the operation when the queue is full
+		std::future<std::vector<std::string> > names = AsyncHandler.trySubmit([](handler::Sqlite3Db &db) {
+				return db.selectRecords("CONNECTIONS", {"NAME"});
+		});
+		if (!names.valid()) {
+				...
+		}
+
+		return 0;
+}
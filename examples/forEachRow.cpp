@@ -0,0 +1,28 @@
+#include <handler.hpp>
+#include <query.hpp>
+
+int main(int argc, char const *argv[]) {
+		handler::Sqlite3Db MyHandler("mydatabase.db");
+		int64_t total_age = 0;
+		size_t name_bytes = 0;
+
+		//In table company created previously
+		bool status = MyHandler.forEachRow("SELECT AGE, NAME FROM COMPANY;", \
+		                                   [&](const handler::RowView &row) {
+				if (!row.isNull(0))
+						total_age += row.getInt64(0);
+
+				//The text is read from the statement, without copying it
+				std::string_view name = row.getText(1);
+				name_bytes += name.size();
+
+				//Return false to stop reading rows
+				return true;
+		});
+
+		if (status == EXIT_SUCCESS) {
+				...
+		}
+
+		return 0;
+}
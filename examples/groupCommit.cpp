@@ -0,0 +1,28 @@
+#include <group_commit.hpp>
+#include <handler.hpp>
+
+int main(int argc, char const *argv[]) {
+		//Commit every 512 writes, or once the oldest one waited 5 ms
+		handler::GroupCommitWriter Writer("mydatabase.db", 512, std::chrono::milliseconds(5));
+
+		//Any number of threads push their writes without blocking each other
+		std::vector<std::thread> producers;
+		for (int i = 0; i < 8; ++i) {
+				producers.emplace_back([&Writer, i] {
+						std::future<bool> done = Writer.insertRecord("CONNECTIONS", {std::to_string(i), "25", "555123", "Alice"});
+						...
+						//The future is resolved once the transaction holding the write is committed
+						if (done.get() == EXIT_SUCCESS) {
+								...
+						}
+				});
+		}
+		for (auto &producer : producers)
+				producer.join();
+
+		//Fewer batches than writes means fewer syncs
+		handler::GroupCommitStats stats = Writer.getStats();
+		std::cout << stats.writes << " writes in " << stats.batches << " commits" << '\n';
+
+		return 0;
+}
@@ -0,0 +1,27 @@
+#include <handler.hpp>
+#include <query.hpp>
+
+int main(int argc, char const *argv[]) {
+		handler::Sqlite3Db MyHandler("mydatabase.db");
+
+		//In table company created previously
+		std::string table_name = "COMPANY";
+		std::vector<std::vector<std::string> > rows;
+
+		                //ID   AGE    PHONE      NAME
+		rows.push_back({"1", "34", "5521664", "James"});
+		rows.push_back({"2", "34", "", "Thomas"});
+		rows.push_back({"3", "51", "5521890", "Maria"});
+
+		//Insert all the rows in a single transaction, one row per statement
+		if (MyHandler.insertRecords(table_name, rows) == EXIT_SUCCESS) {
+				...
+		}
+
+		//Insert the rows packing as many of them as possible in each statement
+		if (MyHandler.insertRecords(table_name, rows, 0) == EXIT_SUCCESS) {
+				...
+		}
+
+		return 0;
+}
@@ -0,0 +1,25 @@
+#include <handler.hpp>
+#include <logger.hpp>
+
+//Sink sending the messages of the library to the log of the application
+class AppSink : public handler::LogSink {
+public:
+		void write(handler::LogLevel level, const char *message) override {
+				...
+		}
+};
+
+int main(int argc, char const *argv[]) {
+		//By default warnings and errors are written to stderr, nothing else is written
+		handler::log::setSink(std::make_shared<AppSink>());
+		handler::log::setLevel(handler::LogLevel::Info);
+
+		handler::Sqlite3Db MyHandler("mydatabase.db");
+		...
+
+		//Bulk jobs can silence the library completely
+		handler::log::setSink(std::make_shared<handler::NullSink>());
+		//Or build it with "cmake -DLOG_MIN_LEVEL=ERROR .." so the rest of messages are not even compiled
+
+		return 0;
+}
@@ -0,0 +1,29 @@
+#include <handler.hpp>
+
+int main(int argc, char const *argv[]) {
+		handler::Sqlite3Db MyHandler("mydatabase.db");
+		std::map<int64_t, std::string> cached_names;
+		...
+
+		//Drop the rows of the cache changed by each commit of this handler
+		size_t listener = MyHandler.onTableChanged("EMPLOYEES", [&cached_names](const handler::TableChange &change) {
+				if (change.external) {
+						cached_names.clear();
+						return;
+				}
+				for (int64_t rowid : change.updated)
+						cached_names.erase(rowid);
+				for (int64_t rowid : change.deleted)
+						cached_names.erase(rowid);
+		});
+
+		MyHandler.updateTable("EMPLOYEES", {{"NAME", "'Eduardo'"}}, "ID = 3");
+		...
+
+		//Commits of other programs only tell that something changed, so the cache is cleared
+		MyHandler.pollExternalChanges();
+
+		MyHandler.removeTableListener(listener);
+
+		return 0;
+}
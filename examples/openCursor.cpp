@@ -0,0 +1,26 @@
+#include <handler.hpp>
+#include <query.hpp>
+
+int main(int argc, char const *argv[]) {
+		handler::Sqlite3Db MyHandler("mydatabase.db");
+		handler::select_query_param options;
+
+		//In table company created previously
+		options.table_name = "COMPANY";
+		options.fields = {"ID", "NAME"};
+		options.where_cond = "AGE > 30";
+
+		//Each row is read from the database when the loop reaches it
+		handler::Cursor cursor = MyHandler.openCursor(options);
+		for (const handler::RowView &row : cursor) {
+				int64_t id = row.getInt64(0);
+				std::string_view name = row.getText(1);
+				...
+		}
+
+		if (cursor.getResultCode() != SQLITE_DONE) {
+				...
+		}
+
+		return 0;
+}
@@ -0,0 +1,37 @@
+#include <handler.hpp>
+#include <query.hpp>
+
+int main(int argc, char const *argv[]) {
+		//Start from one of the presets and change what is needed
+		handler::OpenOptions options = handler::OpenOptions::throughput();
+		options.cache_size = -16 * 1024; //16 MiB of page cache
+
+		//The settings are applied before the handler runs anything on the database
+		handler::Sqlite3Db MyHandler("mydatabase.db", options);
+		...
+
+		//Reconnect with settings for a database that will mostly be read
+		MyHandler.closeConnection();
+		if (MyHandler.connectDb(handler::OpenOptions::readMostly()) == EXIT_SUCCESS) {
+				...
+		}
+
+		//Open a database only for reading
+		options = handler::OpenOptions();
+		options.flags = SQLITE_OPEN_READONLY | SQLITE_OPEN_FULLMUTEX;
+		handler::Sqlite3Db ReadHandler("mydatabase.db", options);
+
+		//Open a file nothing will write while it is open, read through memory mapping
+		options = handler::OpenOptions::readMostly();
+		options.immutable = true;
+		options.count_io = true;
+		handler::Sqlite3Db ArchiveHandler("archive.db", options);
+		...
+		handler::IoStats stats = ArchiveHandler.getIoStats();
+		std::cout << stats.fetch_hits << " pages read from the mapping, " << stats.reads << " copied" << '\n';
+
+		//Memory mapping can be turned off and on at any time
+		ArchiveHandler.setMmapSize(0);
+
+		return 0;
+}
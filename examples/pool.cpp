@@ -0,0 +1,28 @@
+#include <handler.hpp>
+#include <pool.hpp>
+#include <thread>
+
+int main(int argc, char const *argv[]) {
+		//Four handlers connected to the same file, in WAL mode
+		handler::Sqlite3DbPool MyPool("mydatabase.db", 4);
+		std::vector<std::thread> workers;
+
+		for (int i = 0; i < 4; ++i) {
+				workers.emplace_back([&MyPool] {
+						//The handler is reserved for this thread until the lease is destroyed
+						handler::PooledDb db = MyPool.acquire();
+
+						//In table company created previously
+						std::vector<std::string> data = db->selectRecords("COMPANY");
+						...
+				});
+		}
+		for (auto &worker : workers)
+				worker.join();
+
+		//Check how long the threads waited for a free handler
+		handler::PoolStats stats = MyPool.getStats();
+		...
+
+		return 0;
+}
@@ -0,0 +1,29 @@
+#include <handler.hpp>
+#include <query.hpp>
+
+int main(int argc, char const *argv[]) {
+
+		handler::Sqlite3Db MyHandler("mydatabase.db");
+
+		/* Statements that will be executed many times during the program */
+		std::string count_query = query::cmd::select + "COUNT(*)" + query::cl::from + "COMPANY" \
+		                          + query::end_query;
+		std::string names_query = query::cmd::select + "NAME" + query::cl::from + "COMPANY" \
+		                          + query::end_query;
+
+		/* Compile them once. They are compiled again on every connectDb() */
+		if (MyHandler.prepareStatements({count_query, names_query}) == EXIT_SUCCESS) {
+				std::vector<std::string> data;
+
+				/* Every execution reuses the compiled statement */
+				for (int i = 0; i < 1000; ++i) {
+						MyHandler.executeQuery(count_query.c_str(), data, {0});
+				}
+		}
+
+		/* Check how effective the cache was */
+		handler::StatementCacheStats stats = MyHandler.getStatementCacheStats();
+		std::cout << stats.hits << " hits, " << stats.misses << " misses" << '\n';
+
+		return 0;
+}
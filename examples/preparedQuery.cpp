@@ -0,0 +1,28 @@
+#include <handler.hpp>
+
+int main(int argc, char const *argv[]) {
+		handler::Sqlite3Db MyHandler("mydatabase.db");
+
+		//In table company created previously, the statement is compiled once
+		handler::PreparedQuery insert = MyHandler.prepare("INSERT INTO COMPANY (ID, NAME, SALARY) VALUES (?, ?, ?);");
+		for (int64_t id = 1; id <= 1000; ++id) {
+				insert.bind(1, id);
+				insert.bind(2, "Employee");
+				insert.bind(3, 1500.0);
+				if (!insert.step() && insert.getResultCode() != SQLITE_DONE) {
+						...
+				}
+				insert.reset();
+		}
+
+		//Parameters can also be bound by name, and columns are read in their own type
+		handler::PreparedQuery select = MyHandler.prepare("SELECT NAME, SALARY FROM COMPANY WHERE ID = :id;");
+		select.bind(":id", int64_t(42));
+		while (select.step()) {
+				std::string_view name = select.getText(0);
+				double salary = select.getDouble(1);
+				...
+		}
+
+		return 0;
+}
@@ -0,0 +1,44 @@
+#include <handler.hpp>
+
+struct Employee {
+		int64_t id;
+		std::string name;
+		std::optional<double> salary;
+};
+
+//Members filled from the columns selected, in the same order
+namespace handler {
+template <>
+struct RowMapping<Employee> {
+		static constexpr auto fields = std::make_tuple(&Employee::id, &Employee::name, &Employee::salary);
+};
+}
+
+int main(int argc, char const *argv[]) {
+		handler::Sqlite3Db MyHandler("mydatabase.db");
+		handler::select_query_param options;
+
+		//In table company created previously
+		options.table_name = "COMPANY";
+		options.fields = {"ID", "NAME", "SALARY"};
+		options.where_cond = "AGE > 30";
+
+		//Into tuples, each value read in the type of its element
+		std::vector<std::tuple<int64_t, std::string, double> > tuples;
+		if (MyHandler.selectAs(options, tuples) == EXIT_SUCCESS) {
+				for (const auto &[id, name, salary] : tuples) {
+						...
+				}
+		}
+
+		//Into structs, a NULL salary is left empty
+		std::vector<Employee> employees;
+		MyHandler.selectAs(options, employees);
+		for (const Employee &employee : employees) {
+				if (!employee.salary) {
+						...
+				}
+		}
+
+		return 0;
+}
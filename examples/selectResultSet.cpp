@@ -0,0 +1,37 @@
+#include <handler.hpp>
+#include <query.hpp>
+
+int main(int argc, char const *argv[]) {
+		handler::Sqlite3Db MyHandler("mydatabase.db");
+		handler::select_query_param options;
+		handler::ResultSet result;
+
+		//In table company created previously
+		options.table_name = "COMPANY";
+		options.fields = {"ID", "AGE", "PHONE", "NAME"};
+		options.where_cond = "AGE > 30";
+
+		if (MyHandler.selectRecords(options, result) == EXIT_SUCCESS) {
+				int64_t total_age = 0;
+
+				//Numeric columns are stored contiguously, one value per row
+				for (int64_t age : result.integers(1))
+						total_age += age;
+
+				for (size_t row = 0; row < result.rowCount(); ++row) {
+						//NULL values keep their place in the row
+						if (!result.isNull(row, 2))
+								...
+						std::string_view name = result.getText(row, 3);
+						...
+				}
+		}
+
+		//Any query can be stored in a result set
+		if (MyHandler.executeQuery("SELECT AVG(AGE) AS AVERAGE FROM COMPANY;", result) == EXIT_SUCCESS) {
+				double average = result.getDouble(0, result.columnIndex("AVERAGE"));
+				...
+		}
+
+		return 0;
+}
@@ -0,0 +1,19 @@
+#include <handler.hpp>
+
+//Build the library with "cmake -DSTATEMENT_STATS=ON .." to measure the statements
+int main(int argc, char const *argv[]) {
+		handler::Sqlite3Db MyHandler("mydatabase.db");
+		...
+
+		//Statements are grouped by their sql, with the literal values replaced by "?"
+		for (const handler::StatementStats &stats : MyHandler.getStatementStats()) {
+				std::cout << stats.sql << ": " << stats.calls << " calls, " << stats.rows << " rows, "
+				          << "p50 " << stats.p50_ns / 1000 << " us, p99 " << stats.p99_ns / 1000 << " us, "
+				          << "max " << stats.max_ns / 1000 << " us" << '\n';
+		}
+
+		//Start measuring again, for instance after a latency spike was dumped
+		MyHandler.resetStatementStats();
+
+		return 0;
+}
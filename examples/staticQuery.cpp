@@ -0,0 +1,23 @@
+#include <handler.hpp>
+#include <static_query.hpp>
+
+//The sql of these queries is composed by the compiler, they are plain strings at runtime
+static constexpr auto insert_user = query::fixed::insertInto("USERS", "NAME", "AGE");
+static constexpr auto adults = query::fixed::select("NAME", "AGE").from("USERS") \
+                               .where("AGE >= ?").orderBy("AGE DESC").limit<10>();
+
+//Clauses out of order do not compile:
+//query::fixed::select("NAME").where("AGE > 18").from("USERS");
+
+int main(int argc, char const *argv[]) {
+		handler::Sqlite3Db MyHandler("mydatabase.db");
+		std::vector<std::string> data;
+		...
+
+		MyHandler.executeQuery(insert_user, {"Ann", "34"}, data);
+
+		//The statement is compiled on the first execution and taken from the cache afterwards
+		MyHandler.executeQuery(adults, {"18"}, data, {0, 1});
+
+		return 0;
+}
@@ -0,0 +1,32 @@
+#include <handler.hpp>
+#include <query.hpp>
+#include <transaction.hpp>
+
+int main(int argc, char const *argv[]) {
+		handler::Sqlite3Db MyHandler("mydatabase.db");
+
+		/* Take the write lock from the beginning, so no other writer can get in between */
+		{
+				handler::Transaction transaction(MyHandler, handler::TransactionMode::Immediate);
+
+				MyHandler.insertRecord("COMPANY", {"1", "34", "5521664", "James"});
+
+				/* Changes done inside of a savepoint can be discarded on their own */
+				{
+						handler::Savepoint savepoint(MyHandler);
+
+						if (MyHandler.insertRecord("COMPANY", {"2", "34", "", "Thomas"}) == EXIT_FAILURE)
+								savepoint.rollback();
+				}
+
+				if (MyHandler.updateTable("COMPANY", {{"AGE", "35"}}, "ID = ?", {"1"}) == EXIT_FAILURE) {
+						/* Nothing done inside of the transaction is kept */
+						transaction.rollback();
+				}
+
+				/* Leaving the scope commits the transaction if it is still active. An exception
+				   thrown inside of the scope rolls it back instead */
+		}
+
+		return 0;
+}
@@ -0,0 +1,238 @@
+/*
+ * This file is part of Sqlite3Utils.
+ *
+ * Sqlite3Utils is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Sqlite3Utils is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Sqlite3Utils.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef SQLITE3ASYNC_H
+#define SQLITE3ASYNC_H
+
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+#include "handler.hpp"
+
+namespace handler {
+
+/*!
+ * \brief Output of a query run asynchronously.
+ */
+struct QueryResult {
+		bool status = EXIT_FAILURE;/*!< EXIT_SUCCESS if the query was executed correctly.*/
+		std::vector<std::string> data;/*!< Values retrieved from the indexes requested.*/
+};
+
+/*! \brief Handler running its operations on a worker thread.
+ *
+ * The worker owns a Sqlite3Db with its own connection and runs the operations one after the
+ * other, in the order they were submitted. Each call returns at once with a std::future that
+ * receives the result, which is moved from the worker to the caller. Waiting operations are
+ * kept in a queue of bounded depth: submitting to a full queue blocks until the worker takes
+ * one, unless trySubmit() is used. Operations already queued are run before the handler is
+ * destroyed.
+ *
+ * \include async.cpp
+ */
+class AsyncSqlite3Db {
+public:
+		/*!
+		 * \brief Open the connection of the worker and start it.
+		 *
+		 * @param db_path     Path to the database file. It is created if it does not exist.
+		 * @param queue_depth Maximum number of operations waiting for the worker, at least 1.
+		 *  Default value is 64.
+		 * @param options     Settings applied to the connection of the worker.
+		 */
+		AsyncSqlite3Db(std::string db_path, size_t queue_depth = 64, \
+		               const OpenOptions &options = OpenOptions());
+
+		/*!
+		 * \brief Run the operations still queued, then stop the worker and close its connection.
+		 */
+		~AsyncSqlite3Db();
+
+		AsyncSqlite3Db(const AsyncSqlite3Db&) = delete;
+		AsyncSqlite3Db& operator=(const AsyncSqlite3Db&) = delete;
+
+		/*!
+		 * \brief Execute an SQLite query on the worker.
+		 *
+		 * @param  sql_query    The query to be executed.
+		 * @param  indexes_stmt The indexes of the output that will be extracted.
+		 *
+		 * @return              Future receiving the status and the data retrieved.
+		 */
+		std::future<QueryResult> executeQuery(std::string sql_query, std::vector<int> indexes_stmt = {});
+
+		/*!
+		 * \brief Execute an SQLite query with "?" placeholders on the worker.
+		 *
+		 * @param  sql_query    The query to be executed, containing "?" placeholders.
+		 * @param  bind_values  Values bound, in order, to the placeholders of the query.
+		 * @param  indexes_stmt The indexes of the output that will be extracted.
+		 *
+		 * @return              Future receiving the status and the data retrieved.
+		 *
+		 * @overload
+		 */
+		std::future<QueryResult> executeQuery(std::string sql_query, std::vector<std::string> bind_values, \
+		                                      std::vector<int> indexes_stmt);
+
+		/*!
+		 * \brief Select records on the worker.
+		 *
+		 * @param  select_options Structure containing all the options of the select statement.
+		 *
+		 * @return                Future receiving the values retrieved, as returned by
+		 *  Sqlite3Db::selectRecords().
+		 */
+		std::future<std::vector<std::string> > selectRecords(select_query_param select_options);
+
+		/*!
+		 * \brief Insert a record on the worker.
+		 *
+		 * @param  table_name Table where the record is inserted.
+		 * @param  values     Values of the fields of the record.
+		 *
+		 * @return            Future receiving EXIT_SUCCESS or EXIT_FAILURE.
+		 */
+		std::future<bool> insertRecord(std::string table_name, std::vector<std::string> values);
+
+		/*!
+		 * \brief Update the records of a table on the worker.
+		 *
+		 * @param  table_name Table where the update operation will take place.
+		 * @param  set_fields Container of pairs with the name of a field and the value it takes.
+		 * @param  where_cond Condition the records updated meet. Empty updates all of them.
+		 *
+		 * @return            Future receiving EXIT_SUCCESS or EXIT_FAILURE.
+		 */
+		std::future<bool> updateTable(std::string table_name, std::vector<FieldDescription> set_fields, \
+		                              std::string where_cond = "");
+
+		/*!
+		 * \brief Run any operation on the handler of the worker.
+		 *
+		 * The operation receives the handler and its return value is moved into the future.
+		 * Exceptions thrown by it are stored in the future too. The handler must not be kept
+		 * once the operation returns.
+		 *
+		 * @param  operation Callable taking a Sqlite3Db&.
+		 *
+		 * @return           Future receiving the value returned by the operation.
+		 */
+		template<typename Operation>
+		auto submit(Operation &&operation) -> std::future<std::invoke_result_t<Operation, Sqlite3Db&> > {
+				std::future<std::invoke_result_t<Operation, Sqlite3Db&> > result;
+				enqueue(makeJob(std::forward<Operation>(operation), result), true);
+				return result;
+		};
+
+		/*!
+		 * \brief Run an operation on the worker only if the queue is not full.
+		 *
+		 * @param  operation Callable taking a Sqlite3Db&.
+		 *
+		 * @return           Future receiving the value returned by the operation. It is not
+		 *  valid() if the queue was full and the operation was not queued.
+		 */
+		template<typename Operation>
+		auto trySubmit(Operation &&operation) -> std::future<std::invoke_result_t<Operation, Sqlite3Db&> > {
+				std::future<std::invoke_result_t<Operation, Sqlite3Db&> > result;
+				if (!enqueue(makeJob(std::forward<Operation>(operation), result), false))
+						return std::future<std::invoke_result_t<Operation, Sqlite3Db&> >();
+				return result;
+		};
+
+		/*!
+		 * \brief Check if the connection of the worker is open.
+		 */
+		bool isConnected() const;
+
+		/*!
+		 * \brief Get the number of operations waiting for the worker.
+		 */
+		size_t pending() const;
+
+		/*!
+		 * \brief Get the maximum number of operations waiting for the worker.
+		 */
+		size_t queueDepth() const {
+				return _queue_depth;
+		};
+
+private:
+		/*! \brief Operation waiting in the queue, with the type of its result erased. */
+		class Job {
+public:
+				virtual ~Job() = default;
+				virtual void run(Sqlite3Db &db) = 0;
+		};
+
+		template<typename Result>
+		class Task : public Job {
+public:
+				template<typename Operation>
+				explicit Task(Operation &&operation) : _task(std::forward<Operation>(operation)) {
+				};
+
+				void run(Sqlite3Db &db) override {
+						_task(db);
+				};
+
+				std::packaged_task<Result(Sqlite3Db&)> _task;/*!< Operation and the promise of its result.*/
+		};
+
+		template<typename Operation, typename Result>
+		static std::unique_ptr<Job> makeJob(Operation &&operation, std::future<Result> &result){
+				auto task = std::make_unique<Task<Result> >(std::forward<Operation>(operation));
+				result = task->_task.get_future();
+				return task;
+		};
+
+		/*!
+		 * \brief Put a job in the queue.
+		 *
+		 * @param  job  Job to be run by the worker.
+		 * @param  wait Whether to wait for room in the queue when it is full.
+		 *
+		 * @return      True if the job was queued. False if the queue was full and wait is false.
+		 */
+		bool enqueue(std::unique_ptr<Job> job, bool wait);
+
+		/*!
+		 * \brief Loop of the worker thread, running jobs until the handler is destroyed.
+		 */
+		void work();
+
+		std::unique_ptr<Sqlite3Db> _db;/*!< Handler used only by the worker.*/
+		size_t _queue_depth;/*!< Maximum number of jobs in the queue.*/
+		std::deque<std::unique_ptr<Job> > _queue;/*!< Jobs waiting for the worker.*/
+		mutable std::mutex _mutex;/*!< Guards the queue and the stop flag.*/
+		std::condition_variable _queued;/*!< Signaled when a job is queued or the worker must stop.*/
+		std::condition_variable _taken;/*!< Signaled when the worker takes a job from the queue.*/
+		bool _stop = false;/*!< Set when the handler is being destroyed.*/
+		std::thread _worker;/*!< Thread running the jobs.*/
+};
+
+} // namespace handler
+
+#endif // SQLITE3ASYNC_H
@@ -0,0 +1,155 @@
+/*
+ * This file is part of Sqlite3Utils.
+ *
+ * Sqlite3Utils is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Sqlite3Utils is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Sqlite3Utils.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef SQLITE3CHANGENOTIFIER_H
+#define SQLITE3CHANGENOTIFIER_H
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <sqlite3.h>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace handler {
+
+/*!
+ * \brief Rows of a table changed by a committed transaction.
+ */
+struct TableChange {
+		std::string table;/*!< Table changed. For external changes, the table listened to, "" for listeners of every table.*/
+		std::vector<int64_t> inserted;/*!< Rowids of the rows inserted.*/
+		std::vector<int64_t> updated;/*!< Rowids of the rows updated.*/
+		std::vector<int64_t> deleted;/*!< Rowids of the rows deleted.*/
+		bool external = false;/*!< True if the change was committed by another connection, whose rows are not known.*/
+};
+
+typedef std::function<void(const TableChange&)> TableChangeCallback;/*!< Listener of the changes of a table.*/
+
+/*! \brief Notifies the changes committed on the tables of a connection to their listeners.
+ *
+ * The rowids changed are gathered with sqlite3_update_hook() while the transaction is open,
+ * set aside by sqlite3_commit_hook() and discarded by sqlite3_rollback_hook(). The commit hook
+ * runs before the commit is done, so the changes are only delivered, once per table, when the
+ * owner calls dispatch() after the committing statement returns SQLITE_DONE. Listeners can
+ * then read the changes from any connection. Only tables with listeners are gathered. Rows of WITHOUT ROWID
+ * tables, and rows removed by a DELETE without WHERE, are not reported by sqlite3, and rows
+ * changed inside a savepoint that is rolled back are still reported with the transaction.
+ */
+class ChangeNotifier {
+public:
+		ChangeNotifier() = default;
+
+		ChangeNotifier(const ChangeNotifier&) = delete;
+		ChangeNotifier& operator=(const ChangeNotifier&) = delete;
+
+		/*!
+		 * \brief Start watching the changes of a connection.
+		 *
+		 * @param db Connection watched. The notifier must outlive it or be detached first.
+		 */
+		void attach(sqlite3 *db);
+
+		/*!
+		 * \brief Stop watching the changes of a connection.
+		 */
+		static void detach(sqlite3 *db);
+
+		/*!
+		 * \brief Add a listener of the changes of a table.
+		 *
+		 * @param  table    Name of the table, or "" to listen to every table.
+		 * @param  callback Function called with the changes of each commit.
+		 *
+		 * @return          Identifier of the listener, to remove it.
+		 */
+		size_t subscribe(const std::string &table, TableChangeCallback callback);
+
+		/*!
+		 * \brief Remove a listener.
+		 *
+		 * @return EXIT_SUCCESS if it was removed. EXIT_FAILURE if it did not exist.
+		 */
+		bool unsubscribe(size_t id);
+
+		/*!
+		 * \brief Deliver the changes of the transactions committed so far to their listeners.
+		 *
+		 * Called after a statement of the connection returns SQLITE_DONE. Nothing is done while
+		 * a transaction is still open, such as after a commit that failed.
+		 *
+		 * @param db Connection watched.
+		 */
+		void dispatch(sqlite3 *db);
+
+		/*!
+		 * \brief Record the data version of the connection.
+		 *
+		 * @param  version Value of PRAGMA data_version.
+		 *
+		 * @return         True if it differs from the one recorded before, or none was.
+		 */
+		bool updateDataVersion(int64_t version);
+
+		/*!
+		 * \brief Notify every listener of changes committed by another connection.
+		 *
+		 * Which tables changed is not known, so each listener is called once, with the table it
+		 * listens to.
+		 */
+		void notifyExternal();
+
+private:
+		/*! \brief Listener of a table. */
+		struct Subscription {
+				size_t id;
+				std::string table;
+				TableChangeCallback callback;
+		};
+
+		/*!
+		 * \brief Callbacks given to sqlite3_update_hook(), sqlite3_commit_hook() and
+		 *  sqlite3_rollback_hook().
+		 */
+		static void update(void *context, int operation, const char *database, const char *table, \
+		                   sqlite3_int64 rowid);
+		static int commit(void *context);
+		static void rollback(void *context);
+
+		/*!
+		 * \brief Call the listeners of each change, out of the lock.
+		 */
+		void deliver(const std::vector<TableChange> &changes);
+
+		bool isWatched(const std::string &table) const;
+
+		mutable std::mutex _mutex;/*!< Guards the listeners and the changes pending.*/
+		std::vector<Subscription> _subscriptions;/*!< Listeners, in the order they were added.*/
+		std::unordered_map<std::string, TableChange> _pending;/*!< Changes of the open transaction, by table.*/
+		std::vector<TableChange> _committed;/*!< Changes of the transactions committed, not delivered yet.*/
+		std::atomic<bool> _has_committed{false};/*!< Whether _committed has changes, checked without the lock.*/
+		size_t _next_id = 1;/*!< Identifier of the next listener.*/
+		int64_t _data_version = -1;/*!< Last PRAGMA data_version seen, -1 if none since attached.*/
+};
+
+} // namespace handler
+
+#endif // SQLITE3CHANGENOTIFIER_H
@@ -0,0 +1,94 @@
+/*
+ * This file is part of Sqlite3Utils.
+ *
+ * Sqlite3Utils is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Sqlite3Utils is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Sqlite3Utils.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef SQLITE3COLUMNDESCRIPTOR_H
+#define SQLITE3COLUMNDESCRIPTOR_H
+
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace handler {
+
+/*!
+ * \brief Affinity of a column, as sqlite3 derives it from the declared type.
+ */
+enum class Affinity {
+		Integer,/*!< "INTEGER", values must be integers.*/
+		Real,/*!< "REAL", values must be reals.*/
+		Numeric,/*!< "NUMERIC", values must be reals.*/
+		Text,/*!< "TEXT", any value is stored as text.*/
+		Blob,/*!< "BLOB", any value is stored as given.*/
+		Null/*!< "NULL", only the value "NULL" is accepted.*/
+};
+
+/*!
+ * \brief Description of a column of a table, as given by pragma_table_info.
+ */
+struct ColumnDescriptor {
+		std::string name;/*!< Name of the column.*/
+		std::string declared_type;/*!< Type the column was declared with, may be empty.*/
+		Affinity affinity = Affinity::Blob;/*!< Affinity derived from the declared type.*/
+		bool not_null = false;/*!< True if the column has a NOT NULL constraint.*/
+		int primary_key = 0;/*!< Position of the column in the primary key starting at 1, or 0 if it is not part of it.*/
+		std::optional<std::string> default_value;/*!< Default value as written in the table definition, if any.*/
+
+		/*!
+		 * \brief Check if the values of the column are bound exactly as text.
+		 *
+		 * @return True for "TEXT" and "BLOB" affinities, which accept any value.
+		 */
+		bool bindsAsText() const {
+				return affinity == Affinity::Text || affinity == Affinity::Blob;
+		};
+};
+
+bool operator==(const ColumnDescriptor &a, const ColumnDescriptor &b);
+bool operator!=(const ColumnDescriptor &a, const ColumnDescriptor &b);
+
+/*!
+ * \brief Calculate the affinity of a declared type.
+ *
+ * The rules are the ones of Sqlite3Db::getAffinity(), applied without copying the type.
+ *
+ * @param  declared_type Datatype of the column, in any case.
+ *
+ * @return               The affinity of the datatype.
+ */
+Affinity affinityOf(std::string_view declared_type);
+
+/*!
+ * \brief Get the affinity named by a token such as "INTEGER" or "NULL".
+ *
+ * @param  name Affinity token, as returned by Sqlite3Db::getAffinity().
+ *
+ * @return      The affinity, or Affinity::Text if the token is not one of them, since both
+ *  accept any value.
+ */
+Affinity affinityFromName(std::string_view name);
+
+/*!
+ * \brief Get the token of an affinity.
+ *
+ * @return "INTEGER", "REAL", "NUMERIC", "TEXT", "BLOB" or "NULL".
+ */
+const std::string &affinityName(Affinity affinity);
+
+} // namespace handler
+
+#endif // SQLITE3COLUMNDESCRIPTOR_H
@@ -0,0 +1,73 @@
+/*
+ * This file is part of Sqlite3Utils.
+ *
+ * Sqlite3Utils is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Sqlite3Utils is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Sqlite3Utils.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef SQLITE3COUNTINGVFS_H
+#define SQLITE3COUNTINGVFS_H
+
+#include <cstdint>
+#include <sqlite3.h>
+
+namespace handler {
+
+/*!
+ * \brief Counters of the page reads done on a database file.
+ */
+struct IoStats {
+		uint64_t reads = 0;/*!< Number of reads copied from the file with xRead (pread).*/
+		uint64_t read_bytes = 0;/*!< Bytes copied by those reads.*/
+		uint64_t fetches = 0;/*!< Number of pages requested through memory mapping (xFetch).*/
+		uint64_t fetch_hits = 0;/*!< Requests served directly from the memory mapped file.*/
+};
+
+/*! \brief VFS that counts the reads done on each file before passing them to the default VFS.
+ *
+ * The shim only counts, every operation is done by the default VFS of the process. A
+ * connection uses it when it is opened with the name returned by registerCountingVfs().
+ */
+namespace vfs {
+
+/*!
+ * \brief Register the counting VFS, on top of the current default VFS, the first time it is called.
+ *
+ * @return The name of the VFS, to be given to sqlite3_open_v2(). NULL if it could not be
+ *  registered.
+ */
+const char *registerCountingVfs();
+
+/*!
+ * \brief Get the counters of the main database file of a connection.
+ *
+ * @param  db    Connection opened with the counting VFS.
+ * @param  stats Where the counters are copied.
+ *
+ * @return       True if the connection uses the counting VFS. False otherwise.
+ */
+bool getIoStats(sqlite3 *db, IoStats &stats);
+
+/*!
+ * \brief Set the counters of the main database file of a connection back to 0.
+ *
+ * @param  db Connection opened with the counting VFS.
+ */
+void resetIoStats(sqlite3 *db);
+
+} // namespace vfs
+
+} // namespace handler
+
+#endif // SQLITE3COUNTINGVFS_H
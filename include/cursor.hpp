@@ -0,0 +1,249 @@
+/*
+ * This file is part of Sqlite3Utils.
+ *
+ * Sqlite3Utils is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Sqlite3Utils is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Sqlite3Utils.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef SQLITE3CURSOR_H
+#define SQLITE3CURSOR_H
+
+#include <cstdint>
+#include <iterator>
+#include <sqlite3.h>
+#include <string_view>
+#include "result_set.hpp"
+#include "statement_cache.hpp"
+
+namespace handler {
+
+class Sqlite3Db;
+
+/*!
+ * \brief Bytes of a blob value, owned by the statement it was read from.
+ */
+struct BlobView {
+		const unsigned char *data = NULL;/*!< First byte of the blob, NULL if it is empty.*/
+		size_t size = 0;/*!< Number of bytes of the blob.*/
+};
+
+/*! \brief View over the current row of a statement being stepped.
+ *
+ * The view does not copy anything: every getter reads straight from the statement, and the
+ * text and blobs returned are only valid until the statement is stepped again.
+ */
+class RowView {
+public:
+		explicit RowView(sqlite3_stmt *stmt = NULL) : _stmt(stmt) {
+		};
+
+		/*!
+		 * \brief Get the number of columns of the row.
+		 */
+		int columnCount() const {
+				return sqlite3_column_count(_stmt);
+		};
+
+		/*!
+		 * \brief Get the name of a column.
+		 */
+		const char *columnName(int column) const {
+				return sqlite3_column_name(_stmt, column);
+		};
+
+		/*!
+		 * \brief Get the type of the value stored in a column of the row.
+		 *
+		 * Unlike the columns of a ResultSet, each value of a column may have a different type.
+		 */
+		ColumnType columnType(int column) const {
+				switch (sqlite3_column_type(_stmt, column)) {
+				case SQLITE_INTEGER:
+						return ColumnType::Integer;
+				case SQLITE_FLOAT:
+						return ColumnType::Real;
+				case SQLITE_TEXT:
+						return ColumnType::Text;
+				case SQLITE_BLOB:
+						return ColumnType::Blob;
+				default:
+						return ColumnType::Null;
+				}
+		};
+
+		/*!
+		 * \brief Check if the value of a column is NULL.
+		 */
+		bool isNull(int column) const {
+				return sqlite3_column_type(_stmt, column) == SQLITE_NULL;
+		};
+
+		/*!
+		 * \brief Get the value of a column as an integer.
+		 */
+		int64_t getInt64(int column) const {
+				return sqlite3_column_int64(_stmt, column);
+		};
+
+		/*!
+		 * \brief Get the value of a column as a real number.
+		 */
+		double getDouble(int column) const {
+				return sqlite3_column_double(_stmt, column);
+		};
+
+		/*!
+		 * \brief Get the value of a column as text, valid until the next step.
+		 */
+		std::string_view getText(int column) const {
+				const char *text = reinterpret_cast<const char*>(sqlite3_column_text(_stmt, column));
+				return (text == NULL) ? std::string_view() : \
+				       std::string_view(text, sqlite3_column_bytes(_stmt, column));
+		};
+
+		/*!
+		 * \brief Get the value of a column as a blob, valid until the next step.
+		 */
+		BlobView getBlob(int column) const {
+				BlobView blob;
+				blob.data = static_cast<const unsigned char*>(sqlite3_column_blob(_stmt, column));
+				blob.size = static_cast<size_t>(sqlite3_column_bytes(_stmt, column));
+				return blob;
+		};
+
+private:
+		sqlite3_stmt *_stmt;/*!< Statement positioned on the row.*/
+};
+
+/*! \brief Streaming cursor over the rows of a query.
+ *
+ * The cursor keeps the statement of the query alive and steps it only when the next row is
+ * requested, so rows are available as soon as sqlite3 produces them and memory use does not
+ * grow with the size of the result. The statement goes back to the statement cache of the
+ * handler when the last row is read or the cursor is destroyed, so a cursor must not outlive
+ * the handler that opened it. Rows can be read with next() and row(), or with a range-for:
+ *
+ * \include openCursor.cpp
+ */
+class Cursor {
+public:
+		/*! \brief Input iterator over the rows of a cursor. */
+		class iterator {
+public:
+				typedef std::input_iterator_tag iterator_category;
+				typedef RowView value_type;
+				typedef std::ptrdiff_t difference_type;
+				typedef const RowView* pointer;
+				typedef const RowView& reference;
+
+				explicit iterator(Cursor *cursor = NULL) : _cursor(cursor) {
+				};
+
+				reference operator*() const {
+						return _cursor->row();
+				};
+
+				pointer operator->() const {
+						return &_cursor->row();
+				};
+
+				iterator& operator++(){
+						if (!_cursor->next())
+								_cursor = NULL;
+						return *this;
+				};
+
+				bool operator==(const iterator &other) const {
+						return _cursor == other._cursor;
+				};
+
+				bool operator!=(const iterator &other) const {
+						return _cursor != other._cursor;
+				};
+
+private:
+				Cursor *_cursor;/*!< Cursor iterated, NULL once the rows are over.*/
+		};
+
+		Cursor() = default;
+
+		Cursor(Cursor&&) = default;
+		Cursor& operator=(Cursor&&) = default;
+
+		/*!
+		 * \brief Step to the next row of the result.
+		 *
+		 * @return True if a row is available through row(). False when the rows are over or an
+		 *  error happened, which can be told apart with getResultCode().
+		 */
+		bool next();
+
+		/*!
+		 * \brief Get the row the cursor is positioned on.
+		 */
+		const RowView &row() const {
+				return _row;
+		};
+
+		/*!
+		 * \brief Give the statement back before the cursor is destroyed.
+		 */
+		void close();
+
+		/*!
+		 * \brief Check if the cursor has a statement to step.
+		 *
+		 * @return False if the query could not be compiled or the cursor was closed.
+		 */
+		bool isOpen() const {
+				return static_cast<bool>(_stmt);
+		};
+
+		/*!
+		 * \brief Get the sqlite3 result code of the latest step.
+		 *
+		 * @return SQLITE_ROW while rows are available, SQLITE_DONE once all of them were read,
+		 *  or the error code of the step that failed.
+		 */
+		int getResultCode() const {
+				return _rc;
+		};
+
+		/*!
+		 * \brief Get an iterator to the first row not read yet.
+		 *
+		 * The rows can only be iterated once.
+		 */
+		iterator begin();
+
+		iterator end() {
+				return iterator();
+		};
+
+private:
+		friend class Sqlite3Db;
+
+		Cursor(CachedStatement &&stmt, Sqlite3Db *handler);
+
+		CachedStatement _stmt;/*!< Statement stepped by the cursor.*/
+		sqlite3 *_db = NULL;/*!< Connection of the statement, used to report errors.*/
+		Sqlite3Db *_handler = NULL;/*!< Handler that prepared the cursor, told when a statement is done.*/
+		RowView _row;/*!< View over the current row.*/
+		int _rc = SQLITE_OK;/*!< Result code of the latest step.*/
+		bool _started = false;/*!< Whether the first row was already requested.*/
+};
+
+} // namespace handler
+
+#endif // SQLITE3CURSOR_H
@@ -0,0 +1,192 @@
+/*
+ * This file is part of Sqlite3Utils.
+ *
+ * Sqlite3Utils is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Sqlite3Utils is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Sqlite3Utils.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef SQLITE3GROUPCOMMIT_H
+#define SQLITE3GROUPCOMMIT_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "handler.hpp"
+
+namespace handler {
+
+/*!
+ * \brief Counters describing the work of a GroupCommitWriter.
+ */
+struct GroupCommitStats {
+		uint64_t writes = 0;/*!< Number of writes run by the writer thread.*/
+		uint64_t failed = 0;/*!< Number of writes that failed or were rolled back.*/
+		uint64_t batches = 0;/*!< Number of transactions committed, each one with its own sync.*/
+		uint64_t max_batch = 0;/*!< Largest number of writes committed together.*/
+};
+
+/*! \brief Writer grouping the writes of many threads into shared transactions.
+ *
+ * Producer threads push their inserts, updates and deletes into a lock-free queue and get a
+ * std::future back. A single writer thread, owning its own connection, takes every write
+ * pending and runs them inside one transaction, which is committed once the batch reaches
+ * the size given or the oldest write of the batch waited the time given. Each write runs in
+ * its own savepoint, so a failing write is rolled back without affecting the rest of the
+ * batch. The futures are only resolved once the transaction is committed, so a write
+ * reported as successful is on disk as far as the synchronous setting of the connection
+ * guarantees: N writes cost one sync instead of N.
+ *
+ * Writes must not be pushed while the writer is being destroyed. The ones already pushed are
+ * committed before the destructor returns.
+ *
+ * \include groupCommit.cpp
+ */
+class GroupCommitWriter {
+public:
+		/*!
+		 * \brief Open the connection of the writer and start its thread.
+		 *
+		 * @param db_path   Path to the database file. It is created if it does not exist.
+		 * @param max_batch Number of writes that triggers a commit, at least 1. Default value is 256.
+		 * @param max_delay Longest time a write waits for the batch to fill before it is
+		 *  committed. 0 commits whatever is pending as soon as the writer is free. Default value
+		 *  is 2 ms.
+		 * @param options   Settings of the connection of the writer. Default value is
+		 *  OpenOptions::durable().
+		 */
+		GroupCommitWriter(std::string db_path, size_t max_batch = 256, \
+		                  std::chrono::microseconds max_delay = std::chrono::milliseconds(2), \
+		                  const OpenOptions &options = OpenOptions::durable());
+
+		/*!
+		 * \brief Commit the writes still pending, then stop the writer and close its connection.
+		 */
+		~GroupCommitWriter();
+
+		GroupCommitWriter(const GroupCommitWriter&) = delete;
+		GroupCommitWriter& operator=(const GroupCommitWriter&) = delete;
+
+		/*!
+		 * \brief Insert a record in the next batch.
+		 *
+		 * @param  table_name Table where the record is inserted.
+		 * @param  values     Values of the fields of the record.
+		 *
+		 * @return            Future receiving EXIT_SUCCESS once the record is committed, or
+		 *  EXIT_FAILURE if it could not be inserted or the batch could not be committed.
+		 */
+		std::future<bool> insertRecord(std::string table_name, std::vector<std::string> values);
+
+		/*!
+		 * \brief Update the records of a table in the next batch.
+		 *
+		 * @param  table_name Table where the update operation will take place.
+		 * @param  set_fields Container of pairs with the name of a field and the value it takes.
+		 * @param  where_cond Condition the records updated meet. Empty updates all of them.
+		 *
+		 * @return            Future receiving EXIT_SUCCESS once the update is committed.
+		 *  EXIT_FAILURE otherwise.
+		 */
+		std::future<bool> updateTable(std::string table_name, std::vector<FieldDescription> set_fields, \
+		                              std::string where_cond = "");
+
+		/*!
+		 * \brief Delete the records of a table in the next batch.
+		 *
+		 * @param  table_name Table where the records are deleted.
+		 * @param  condition  Condition the records deleted meet.
+		 *
+		 * @return            Future receiving EXIT_SUCCESS once the deletion is committed.
+		 *  EXIT_FAILURE otherwise.
+		 */
+		std::future<bool> deleteRecords(std::string table_name, std::string condition);
+
+		/*!
+		 * \brief Run any write in the next batch.
+		 *
+		 * @param  write Function doing the write on the handler of the writer. It returns
+		 *  EXIT_SUCCESS or EXIT_FAILURE, and must not begin or end transactions itself.
+		 *
+		 * @return       Future receiving the value returned once the batch is committed, or
+		 *  EXIT_FAILURE if the batch could not be committed.
+		 */
+		std::future<bool> submit(std::function<bool(Sqlite3Db&)> write);
+
+		/*!
+		 * \brief Check if the connection of the writer is open.
+		 */
+		bool isConnected() const;
+
+		/*!
+		 * \brief Get the counters of the writes and batches committed.
+		 */
+		GroupCommitStats getStats() const;
+
+private:
+		/*! \brief Write waiting in the queue, linked to the one pushed before it. */
+		struct PendingWrite {
+				PendingWrite *next = NULL;/*!< Write pushed right before this one.*/
+				std::function<bool(Sqlite3Db&)> write;/*!< Operation run by the writer.*/
+				std::promise<bool> done;/*!< Resolved once the batch is committed.*/
+				std::chrono::steady_clock::time_point pushed;/*!< When the write was pushed.*/
+		};
+
+		/*!
+		 * \brief Push a write on top of the queue, without taking any lock.
+		 */
+		std::future<bool> push(std::function<bool(Sqlite3Db&)> write);
+
+		/*!
+		 * \brief Append the writes pushed so far, oldest first, to the batch until it holds
+		 *  max_batch writes. The rest wait for the next batches.
+		 */
+		void takePending(std::vector<std::unique_ptr<PendingWrite> > &batch);
+
+		/*!
+		 * \brief Run the writes of a batch in one transaction and resolve their futures.
+		 */
+		void commitBatch(std::vector<std::unique_ptr<PendingWrite> > &batch);
+
+		/*!
+		 * \brief Loop of the writer thread, committing batches until the writer is destroyed.
+		 */
+		void work();
+
+		std::unique_ptr<Sqlite3Db> _db;/*!< Handler used only by the writer thread.*/
+		size_t _max_batch;/*!< Number of writes that triggers a commit.*/
+		std::chrono::microseconds _max_delay;/*!< Longest time a write waits for the batch to fill.*/
+		std::atomic<PendingWrite*> _head{NULL};/*!< Latest write pushed, the rest follow its links.*/
+		std::deque<std::unique_ptr<PendingWrite> > _overflow;/*!< Writes taken from the stack that did not fit in the batch, oldest first. Only used by the writer thread.*/
+		std::mutex _wake_mutex;/*!< Only used to sleep the writer, never taken by a push on a busy queue.*/
+		std::condition_variable _wake;/*!< Signaled when a write is pushed to an empty queue.*/
+		std::atomic<bool> _stop{false};/*!< Set when the writer is being destroyed.*/
+		std::atomic<uint64_t> _writes{0};/*!< Writes run.*/
+		std::atomic<uint64_t> _failed{0};/*!< Writes failed.*/
+		std::atomic<uint64_t> _batches{0};/*!< Transactions committed.*/
+		std::atomic<uint64_t> _max_batch_seen{0};/*!< Largest batch committed.*/
+		std::thread _worker;/*!< Thread committing the batches.*/
+};
+
+} // namespace handler
+
+#endif // SQLITE3GROUPCOMMIT_H
@@ -22,14 +22,31 @@
 #define SQLITE3HANDLER_H
 
 #include <algorithm>
+#include <functional>
 #include <iostream>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
 #include <sqlite3.h>
 #include <stdlib.h>
 #include <string.h> //strlen
 #include <sys/types.h>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 #include <map>
+#include "change_notifier.hpp"
+#include "column_descriptor.hpp"
+#include "counting_vfs.hpp"
+#include "cursor.hpp"
+#include "logger.hpp"
+#include "numeric_validation.hpp"
+#include "prepared_query.hpp"
 #include "query.hpp"
+#include "result_set.hpp"
+#include "row_mapping.hpp"
+#include "statement_cache.hpp"
+#include "statement_stats.hpp"
 
 
 /*! \brief Contains the Sqlite3Db class and it's types
@@ -41,8 +58,12 @@
 
 namespace handler {
 
+class Savepoint;
+class Sqlite3DbPool;
+class Transaction;
 
-typedef std::map<const std::string, std::vector<std::string> > DbTables;/*!< Type that stores the information of the tables inside of the db.*/
+
+typedef std::map<const std::string, std::vector<ColumnDescriptor> > DbTables;/*!< Type that stores the columns of the tables inside of the db.*/
 typedef std::pair<std::string, std::string> FieldDescription;/*!< For use when defining a field in the create table statement*/
 static std::vector<std::string> empty_vec;/*!< Empty vector used as default value for executeQuery, when no data is extracted, where a vector for the data is needed.*/
 
@@ -61,12 +82,137 @@ struct select_query_param {
 		*/
 };/*!< Structure used for storing all options that may be used during a select query.*/
 
+/*!
+ * \brief Check if two select queries have the same options.
+ */
+bool operator==(const select_query_param &a, const select_query_param &b);
+
+/*!
+ * \brief Hash of every option of a select query.
+ */
+struct SelectQueryHash {
+		size_t operator()(const select_query_param &select_options) const;
+};
+
+/*!
+ * \brief Journal used by sqlite3 to make transactions atomic.
+ */
+enum class JournalMode {
+		Default,/*!< Keep the mode stored in the database file.*/
+		Delete,/*!< Rollback journal deleted at the end of each transaction.*/
+		Truncate,/*!< Rollback journal truncated instead of deleted.*/
+		Persist,/*!< Rollback journal header overwritten instead of deleted.*/
+		Memory,/*!< Rollback journal kept in memory.*/
+		Wal,/*!< Write-ahead log, readers do not block the writer.*/
+		Off/*!< No journal, transactions can not be rolled back safely.*/
+};
+
+/*!
+ * \brief How often sqlite3 waits for the data to reach the disk.
+ */
+enum class SynchronousMode {
+		Default,/*!< Keep the sqlite3 default (FULL).*/
+		Off,/*!< Never wait, the database may be corrupted by a power loss.*/
+		Normal,/*!< Wait at the critical moments. In WAL mode, only the last commits may be lost.*/
+		Full,/*!< Wait at every commit.*/
+		Extra/*!< Like Full, also syncing the directory of the journal.*/
+};
+
+/*!
+ * \brief Where temporary tables and indices are stored.
+ */
+enum class TempStore {
+		Default,/*!< Keep the sqlite3 default.*/
+		File,/*!< Temporary files.*/
+		Memory/*!< Memory.*/
+};
+
+/*! \brief Settings applied to a connection when it is opened.
+ *
+ * The settings are applied right after the connection is opened, before the handler runs
+ * any other statement. If one of them can not be applied, the connection is closed and the
+ * open operation fails, so a handler never runs with only part of them. Fields left with
+ * their default value keep the sqlite3 default.
+ *
+ * \include openOptions.cpp
+ */
+struct OpenOptions {
+		int flags = SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE | SQLITE_OPEN_FULLMUTEX;/*!< Flags of sqlite3_open_v2().*/
+		JournalMode journal_mode = JournalMode::Default;/*!< Journal mode of the database.*/
+		SynchronousMode synchronous = SynchronousMode::Default;/*!< Synchronous setting of the connection.*/
+		int cache_size = 0;/*!< Page cache size, in pages if positive or in KiB if negative. 0 keeps the default.*/
+		int64_t mmap_size = -1;/*!< Bytes of the file accessed through memory mapping. -1 keeps the default.*/
+		TempStore temp_store = TempStore::Default;/*!< Storage of temporary tables.*/
+		int page_size = 0;/*!< Page size of a new database, in bytes. 0 keeps the default.*/
+		int busy_timeout_ms = 0;/*!< Time waited for a lock before failing with SQLITE_BUSY. 0 does not wait.*/
+		bool immutable = false;/*!< Open the file read only, assuming nothing changes it while it is open. No locks are taken and the journal settings are ignored.*/
+		bool count_io = false;/*!< Count the reads of the database file, see Sqlite3Db::getIoStats().*/
+
+		/*!
+		 * \brief Settings where every commit is on disk before it returns.
+		 *
+		 * WAL journal with synchronous FULL and a busy timeout of 5 seconds.
+		 */
+		static OpenOptions durable();
+
+		/*!
+		 * \brief Settings for write heavy workloads, trading the last commits on a power loss.
+		 *
+		 * WAL journal with synchronous NORMAL, a 64 MiB page cache, temporary tables in memory,
+		 * 256 MiB of memory mapping and a busy timeout of 5 seconds.
+		 */
+		static OpenOptions throughput();
+
+		/*!
+		 * \brief Settings for workloads that mostly read large databases.
+		 *
+		 * WAL journal with synchronous NORMAL, a 128 MiB page cache, temporary tables in memory,
+		 * 1 GiB of memory mapping and a busy timeout of 5 seconds.
+		 */
+		static OpenOptions readMostly();
+};
+
+/*!
+ * \brief Check the values of a record against the affinities of the columns of a table.
+ *
+ * The affinities are resolved once, when the handler loads the table into its schema, so
+ * checking a record only costs one switch per field instead of querying and parsing the types
+ * of the table.
+ *
+ * @param  columns Columns of the table, as loaded in the schema.
+ * @param  values  Values of the record, in the order of the columns. Empty values are not
+ *  checked, since they are not inserted.
+ *
+ * @return EXIT_SUCCESS if every value is valid for its column. EXIT_FAILURE otherwise.
+ */
+bool validateRecord(const std::vector<ColumnDescriptor> &columns, const std::vector<std::string> &values);
+
+/*! \brief Schema of a database, as loaded by the handlers connected to it.
+ *
+ * Handlers of a Sqlite3DbPool share a single instance, so the schema is loaded once and
+ * changes done through one handler are seen by the rest. Readers lock the mutex in shared
+ * mode, and loading or dropping tables locks it in exclusive mode.
+ */
+struct SchemaInfo {
+		mutable std::shared_mutex mutex;/*!< Guards the tables.*/
+		DbTables tables;/*!< Tables in the database and the description of their columns.*/
+		int64_t schema_version = -1;/*!< PRAGMA schema_version the tables were loaded at, -1 if they were not.*/
+};
+
 /*! \brief Class for handling connection and operations in a sqlite3 database.
  *
  *  This class contains all of the basic operations available in the sqlite3
  *	syntax, including a custom executeQuery(), so that the user can pass their
  *	own querys and obtain the data from them, if preferred over the provided
  *	functionality.
+ *
+ *	A handler can be shared between threads without any outer lock: the connection is
+ *	opened in serialized mode (SQLITE_OPEN_FULLMUTEX), the statement cache and the schema
+ *	have their own locks, and each query keeps its state in local variables. Several
+ *	threads can then call selectRecords() or executeQuery() on the same handler, although
+ *	sqlite3 runs the statements of one connection one after the other. For reads that
+ *	really run in parallel, use one handler per thread or a Sqlite3DbPool. Transactions
+ *	belong to the connection, so only one thread should use them at a time.
  */
 
 class Sqlite3Db {
@@ -82,6 +228,9 @@ public:
 		 * constructor will load all the names of the tables present in the database as
 		 * map keys. Assigned to each of the keys there will be a vector loaded with the
 		 * names of the fields in each table.
+		 *
+		 * If the database can not be opened or loaded, the handler is left disconnected, which
+		 * isConnected() tells.
 		 */
 		Sqlite3Db();
 
@@ -96,6 +245,19 @@ public:
 		 */
 		Sqlite3Db(std::string db_path);
 
+		/*!
+		 * \brief Constructor for user defined database name, with the settings given.
+		 *
+		 * @param db_path name of the database to be connected to.
+		 * @param options settings applied to the connection when it is opened, and every time
+		 *  connectDb() opens it again.
+		 *
+		 * \include openOptions.cpp
+		 *
+		 * @overload
+		 */
+		Sqlite3Db(std::string db_path, const OpenOptions &options);
+
 		/*!
 		 * \brief Destructor of the class Sqlite3Db.
 		 *
@@ -132,6 +294,19 @@ public:
 		 */
 		bool connectDb ();
 
+		/*!
+		 * \brief Reconnects the handler to it's linked database with new settings.
+		 *
+		 * @param  options Settings applied to the connection. They are kept for the following
+		 *  calls to connectDb().
+		 *
+		 * @return         EXIT_SUCCESS if the db was reopened and it's information loaded
+		 *  							 correctly. EXIT_FAILURE otherwise.
+		 *
+		 * @overload
+		 */
+		bool connectDb (const OpenOptions &options);
+
 		/*!
 		 * \brief Create a table in the database with the specified parameters.
 		 *
@@ -170,6 +345,24 @@ public:
 		 */
 		bool deleteRecords(std::string table_name, std::string condition);
 
+		/*!
+		 * \brief Delete the records from a table that meet a parameterized condition.
+		 *
+		 * The condition may contain "?" placeholders, which are bound to the values given
+		 * instead of being pasted inside of the query, so the same compiled statement is
+		 * reused for every set of values.
+		 *
+		 * @param  table_name       Name of the table where the records will be deleted.
+		 * @param  condition        Condition to match for the deletion, using "?" placeholders.
+		 * @param  condition_values Values bound, in order, to the placeholders of the condition.
+		 *
+		 * @return EXIT_SUCCESS if correct. Otherwise EXIT_FAILURE is returned.
+		 *
+		 * @overload
+		 */
+		bool deleteRecords(std::string table_name, std::string condition, \
+		                   const std::vector<std::string> &condition_values);
+
 		/*!
 		 * \brief Drop the table specified
 		 *
@@ -187,6 +380,23 @@ public:
 		 */
 		bool dropTable(std::string table_name);
 
+		/*!
+		 * \brief Compile a list of statements in advance and keep them in the statement cache.
+		 *
+		 * The statements given are remembered by the handler and compiled again every time
+		 *  connectDb() opens the database, so the first execution of each of them does not
+		 *  pay for the sqlite3_prepare_v2() call.
+		 *
+		 * @param  statements Sql texts of the statements that will be used later with
+		 *  executeQuery().
+		 *
+		 * @return EXIT_SUCCESS if all the statements were compiled. EXIT_FAILURE if any of them
+		 *  failed, in which case the rest of them are compiled anyway.
+		 *
+		 * \include prepareStatements.cpp
+		 */
+		bool prepareStatements(const std::vector<std::string> &statements);
+
 		/*!
 		 * \brief Execute an SQLite query and receive the output selected.
 		 *
@@ -212,6 +422,66 @@ public:
 		bool executeQuery(const char *sql_query, std::vector<std::string> &data = empty_vec, \
 		                  std::vector<int> indexes_stmt = {}, bool verbose = false);
 
+		/*!
+		 * \brief Execute an SQLite query with "?" placeholders bound to the values given.
+		 *
+		 * Each value is bound with the sqlite3_bind_*() call matching its content: "NULL" is
+		 * bound as a null value, integer and real numbers as numbers and anything else as text.
+		 *
+		 * @param  sql_query    The query to be executed, containing "?" placeholders.
+		 *
+		 * @param  bind_values  Values bound, in order, to the placeholders of the query.
+		 *
+		 * @param  data         Container to store the data retrieved from the indexes_stmt.
+		 *
+		 * @param  indexes_stmt The indexes of the output that will be extracted.
+		 *
+		 * @param  verbose      If set to true, the result of the query will also be printed.
+		 *
+		 * @return              EXIT_SUCCESS if correct. Otherwise EXIT_FAILURE is returned.
+		 *
+		 * @overload
+		 */
+		bool executeQuery(const char *sql_query, const std::vector<std::string> &bind_values, \
+		                  std::vector<std::string> &data, std::vector<int> indexes_stmt = {}, \
+		                  bool verbose = false);
+
+		/*!
+		 * \brief Execute an SQLite query and store its output in a typed result set.
+		 *
+		 * Every column of the output is stored, with the values read directly in their own
+		 *  type instead of being converted to text.
+		 *
+		 * @param  sql_query The query to be executed.
+		 *
+		 * @param  result    Result set where the output is stored. Its previous content is
+		 *  discarded.
+		 *
+		 * @return           EXIT_SUCCESS if correct. Otherwise EXIT_FAILURE is returned.
+		 *
+		 * @overload
+		 */
+		bool executeQuery(const char *sql_query, ResultSet &result);
+
+		/*!
+		 * \brief Execute an SQLite query and call a function for each row of its output.
+		 *
+		 * The function receives a view over the row, which reads the values straight from the
+		 *  statement, so no copy or allocation is done per row. The text and blobs of the view
+		 *  are only valid until the function returns.
+		 *
+		 * @param  sql_query The query to be executed.
+		 *
+		 * @param  row_fn    Function called with each row. Returning false stops the execution
+		 *  without reading the rest of the rows.
+		 *
+		 * @return           EXIT_SUCCESS if every row was read, or the function stopped the
+		 *  execution. Otherwise EXIT_FAILURE is returned.
+		 *
+		 * \include forEachRow.cpp
+		 */
+		bool forEachRow(const char *sql_query, const std::function<bool(const RowView&)> &row_fn);
+
 		/*!
 		 * \brief Insert record data inside of a table.
 		 *
@@ -231,6 +501,32 @@ public:
 		 */
 		bool insertRecord(std::string table_name, std::vector<std::string> values);
 
+		/*!
+		 * \brief Insert many records inside of a table in a single transaction.
+		 *
+		 * The schema of the table is checked once and the values of every row are validated
+		 *  before anything is written. Then the rows are bound to a single compiled statement
+		 *  and written inside of one transaction, so the whole operation pays one commit. If
+		 *  any row fails, none of them is inserted. When a transaction is already open, the
+		 *  rows are written inside of it.
+		 *
+		 * @param  table_name         Name of the table where the records will be added.
+		 * @param  rows               Container of rows, each of them with the same format used
+		 *  by insertRecord(). Empty strings leave the field undefined.
+		 * @param  rows_per_statement Number of rows packed in the VALUES list of each statement.
+		 *  The value is reduced to fit in the maximum number of variables of a statement, and 0
+		 *  packs as many rows as possible. Default value is 1.
+		 *
+		 * @return EXIT_SUCCESS if all the rows were inserted. Otherwise EXIT_FAILURE is returned.
+		 *
+		 * An example of usage could be as follows:
+		 *
+		 * \include insertRecords.cpp
+		 */
+		bool insertRecords(std::string table_name, \
+		                   const std::vector<std::vector<std::string> > &rows, \
+		                   size_t rows_per_statement = 1);
+
 		/*!
 		 * \brief Selects and extracts the records that meet certain conditions.
 		 *
@@ -296,6 +592,141 @@ public:
 		 */
 		std::vector<std::string>  selectRecords(select_query_param select_options);
 
+		/*!
+		 * \brief Selects the records that meet certain conditions into a typed result set.
+		 *
+		 * Same as the selectRecords() overloads returning strings, but integers and reals are
+		 *  kept as numbers, each column in its own contiguous storage, and NULL values are
+		 *  kept in their place.
+		 *
+		 * @param select_options Structure containing all the necessary options to be used during
+		 * 											 the select statement.
+		 *
+		 * @param result         Result set where the selected records are stored.
+		 *
+		 * @return               EXIT_SUCCESS if correct. Otherwise EXIT_FAILURE is returned.
+		 *
+		 * \include selectResultSet.cpp
+		 */
+		bool selectRecords(select_query_param select_options, ResultSet &result);
+
+		/*!
+		 * \brief Select records straight into tuples or structs.
+		 *
+		 * Each column is read with the sqlite3_column_*() call matching the type of its element
+		 *  (see ColumnValue), so no value goes through text. Elements that are an std::optional
+		 *  are left empty for NULL values. Structs are filled from the members listed in their
+		 *  RowMapping specialization.
+		 *
+		 * @param select_options Options of the select statement. The columns selected are read
+		 *  in order, so fields should not be "*" unless every column of the table is mapped.
+		 *
+		 * @param rows           Where the records are stored. Its previous content is discarded
+		 *  but its capacity is kept, so a vector reused between calls is not allocated again.
+		 *  If a limit is set, room for that many records is reserved, up to 4096 of them.
+		 *
+		 * @return               EXIT_SUCCESS if correct. Otherwise EXIT_FAILURE is returned.
+		 *
+		 * \include selectAs.cpp
+		 */
+		template<typename T>
+		bool selectAs(select_query_param select_options, std::vector<T> &rows){
+				rows.clear();
+				if(this->_db == NULL) {
+						SQLITE3UTILS_LOG_ERROR("Database is not connected, Selection operation aborted");
+						return EXIT_FAILURE;
+				}
+
+				std::shared_ptr<const SelectSql> select = composeSelectQuery(select_options);
+				if (!select)
+						return EXIT_FAILURE;
+
+				/* The limit is only an upper bound, a huge one must not allocate before reading */
+				if (select_options.limit > 0)
+						rows.reserve(std::min<size_t>(select_options.limit, 4096));
+				return queryAs(select->sql.c_str(), rows);
+		};
+
+		/*!
+		 * \brief Execute an SQLite query and read its output straight into tuples or structs.
+		 *
+		 * @param sql_query The query to be executed.
+		 *
+		 * @param rows      Where the rows are stored, as in selectAs().
+		 *
+		 * @return          EXIT_SUCCESS if correct. Otherwise EXIT_FAILURE is returned.
+		 *
+		 * @overload
+		 */
+		template<typename T>
+		bool queryAs(const char *sql_query, std::vector<T> &rows){
+				bool wrong_columns = false;
+
+				rows.clear();
+				bool status = forEachRow(sql_query, [&rows, &wrong_columns](const RowView &row) {
+						/* The columns only need to be checked once */
+						if (rows.empty() && row.columnCount() < static_cast<int>(RowValue<T>::columns)) {
+								wrong_columns = true;
+								return false;
+						}
+						rows.emplace_back();
+						RowValue<T>::read(row, rows.back());
+						return true;
+				});
+
+				if (wrong_columns) {
+						SQLITE3UTILS_LOG_ERROR("The query returns less columns than the %d mapped", \
+						                       static_cast<int>(RowValue<T>::columns));
+						status = EXIT_FAILURE;
+				}
+				if (status == EXIT_FAILURE)
+						rows.clear();
+				return status;
+		};
+
+		/*!
+		 * \brief Open a cursor that reads the records selected one row at a time.
+		 *
+		 * The query is composed as in selectRecords(), but rows are only stepped when the
+		 *  cursor asks for them, so the first one is available right away and the memory used
+		 *  does not depend on the number of rows.
+		 *
+		 * @param select_options Structure containing all the necessary options to be used during
+		 * 											 the select statement.
+		 *
+		 * @return               The cursor over the rows. It is not open (see Cursor::isOpen())
+		 *  if the query could not be composed or compiled.
+		 *
+		 * \include openCursor.cpp
+		 */
+		Cursor openCursor(select_query_param select_options);
+
+		/*!
+		 * \brief Open a cursor that reads the output of a query one row at a time.
+		 *
+		 * @param sql_query The query to be executed.
+		 *
+		 * @return          The cursor over the rows. It is not open if the query could not be
+		 *  compiled.
+		 *
+		 * @overload
+		 */
+		Cursor openCursor(const char *sql_query);
+
+		/*!
+		 * \brief Compile a statement to be bound, stepped and reset by the caller.
+		 *
+		 * @param sql_query The query to be compiled, with "?", "?N", ":name", "@name" or
+		 *  "$name" parameters.
+		 *
+		 * @return          The query ready to be bound. It is not valid (see
+		 *  PreparedQuery::isValid()) if the database is not connected or the query could not
+		 *  be compiled.
+		 *
+		 * \include preparedQuery.cpp
+		 */
+		PreparedQuery prepare(const char *sql_query);
+
 		/*!
 		 * \brief Updates the information contained in the handler.
 		 *
@@ -304,6 +735,9 @@ public:
 		 *  this purpose, execution of this method will updated all the tables and field information
 		 *  that is stored in the handler, so it can operate normally from different connections.
 		 *
+		 * Nothing is loaded if the schema version of the database did not change since the
+		 *  last update, so calling it often only costs reading that version.
+		 *
 		 * @return	EXIT_SUCCESS if the information was updated. EXIT_FAILURE if an error occurred
 		 *  				during the process.
 		 *
@@ -315,6 +749,46 @@ public:
 		 */
 		bool updateHandler();
 
+		/*!
+		 * \brief Listen to the changes committed on a table.
+		 *
+		 * The callback is called once per transaction that changed the table through this
+		 *  handler, with the rowids inserted, updated and deleted, so caches of the table can be
+		 *  invalidated exactly when needed. It is called once the commit is done, on the thread
+		 *  committing before the call that committed returns, so it can read the changes from
+		 *  other connections but must not use this handler. Changes committed by other
+		 *  connections are only noticed by pollExternalChanges(), and some writes are not
+		 *  reported by sqlite3 at all (see ChangeNotifier).
+		 *
+		 * @param  table_name Name of the table, or "" to listen to every table.
+		 * @param  callback   Function called with the changes of the table.
+		 *
+		 * @return            Identifier of the listener, for removeTableListener().
+		 *
+		 * \include onTableChanged.cpp
+		 */
+		size_t onTableChanged(const std::string &table_name, TableChangeCallback callback);
+
+		/*!
+		 * \brief Stop calling a listener added with onTableChanged().
+		 *
+		 * @return EXIT_SUCCESS if the listener was removed. EXIT_FAILURE if it did not exist.
+		 */
+		bool removeTableListener(size_t id);
+
+		/*!
+		 * \brief Check if other connections committed changes since the last check.
+		 *
+		 * Reads PRAGMA data_version, which only changes with commits of other connections. If
+		 *  it did, every listener is called with an external TableChange, since neither the
+		 *  tables nor the rows changed are known. The first check after reconnecting always
+		 *  notifies, as changes may have been missed while disconnected.
+		 *
+		 * @return EXIT_SUCCESS if the check was done, whether there were changes or not.
+		 *  EXIT_FAILURE if the database is not connected or the version could not be read.
+		 */
+		bool pollExternalChanges();
+
 		/*!
 		 * \brief Updates the information contained on a table using a condition given.
 		 *
@@ -338,6 +812,21 @@ public:
 		bool updateTable(std::string table_name, std::vector<FieldDescription> set_fields,\
 			 								std::string where_cond = "");
 
+		/*!
+		 * \brief Updates the information contained on a table using a parameterized condition.
+		 *
+		 * @param  table_name  Table where the update operation will take place.
+		 * @param  set_fields  Container of pairs with the name of a field and the value it takes.
+		 * @param  where_cond  Condition using "?" placeholders.
+		 * @param  where_values Values bound, in order, to the placeholders of the condition.
+		 * @return             EXIT_SUCCESS if the operation completed succesfully, EXIT_FAILURE
+		 *  otherwise
+		 *
+		 * @overload
+		 */
+		bool updateTable(std::string table_name, std::vector<FieldDescription> set_fields, \
+		                 std::string where_cond, const std::vector<std::string> &where_values);
+
 		/*!
 		 * \brief Calculate the affinity token corresponding to a datatype given.
 		 *
@@ -348,9 +837,18 @@ public:
 		 * @param  field_datatype The datatype for which the affinity token will be calculated.
 		 *
 		 * @return								Affinity values "INTEGER", "REAL", "TEXT", "BLOB" or "NUMERIC",
-		 * 												depending on the input.
+		 * 												depending on the input. affinityOf() gives it as an Affinity.
 		 */
-		const std::string getAffinity(const std::string field_datatype);
+		static const std::string getAffinity(const std::string field_datatype);
+
+		/*!
+		 * \brief Get the description of the columns of a table in the database.
+		 *
+		 * @param table_name The name of the table which columns are needed.
+		 *
+		 * @return The columns of the table in their order, empty if the table is not known.
+		 */
+		std::vector<ColumnDescriptor> getColumns(std::string table_name);
 
 		/*!
 		 * \brief Get field's names from a table in the database.
@@ -368,6 +866,73 @@ public:
 		 */
 		size_t getNumTables();
 
+		/*!
+		 * \brief Get the hit and miss counters of the prepared statement cache.
+		 *
+		 * @return The usage statistics of the statement cache.
+		 */
+		StatementCacheStats getStatementCacheStats();
+
+		/*!
+		 * \brief Get the execution counters of the statements run by the handler.
+		 *
+		 * Statements are only measured when the library is built with the STATEMENT_STATS
+		 * option, otherwise no entries are returned and running them costs nothing extra.
+		 *
+		 * @return One entry per normalized sql, the ones that took more time in total first.
+		 *
+		 * \include statementStats.cpp
+		 */
+		std::vector<StatementStats> getStatementStats();
+
+		/*!
+		 * \brief Discard the execution counters of the statements run so far.
+		 */
+		void resetStatementStats();
+
+		/*!
+		 * \brief Set the maximum number of prepared statements kept by the handler.
+		 *
+		 * @param capacity Number of statements cached. 0 disables the statement cache.
+		 */
+		void setStatementCacheSize(size_t capacity);
+
+		/*!
+		 * \brief Change the amount of the database file accessed through memory mapping.
+		 *
+		 * Pages inside the mapped range are read straight from the mapping instead of being
+		 * copied with a read call. sqlite3 caps the size to its compile time SQLITE_MAX_MMAP_SIZE,
+		 * use getMmapSize() to know the one applied.
+		 *
+		 * @param  bytes Bytes mapped from the start of the file. 0 disables memory mapping.
+		 *
+		 * @return       EXIT_SUCCESS if the setting was applied. EXIT_FAILURE otherwise.
+		 */
+		bool setMmapSize(int64_t bytes);
+
+		/*!
+		 * \brief Get the amount of the database file accessed through memory mapping.
+		 *
+		 * @return Bytes mapped, 0 if memory mapping is disabled, or -1 on error.
+		 */
+		int64_t getMmapSize();
+
+		/*!
+		 * \brief Get the read counters of the database file.
+		 *
+		 * Only available if the handler was opened with OpenOptions::count_io. The ratio of
+		 * fetch_hits over the page reads tells how many of them were served by memory mapping.
+		 *
+		 * @return The counters since the connection was opened or resetIoStats() was called. All
+		 *  of them are 0 if the reads are not counted.
+		 */
+		IoStats getIoStats();
+
+		/*!
+		 * \brief Set the read counters of the database file back to 0.
+		 */
+		void resetIoStats();
+
 		/*!
 		 * \brief Get tables information map stored in the handler.
 		 *
@@ -395,17 +960,19 @@ public:
 
 				output << "Handler for database "<< sqlite3Db._db_path << '\n';
 				output << '\n' << "The following information is managed: "<< '\n';
-				output << sqlite3Db._tables.size() << " number of tables...";
 
-				for (auto table : sqlite3Db._tables) {
+				std::shared_lock<std::shared_mutex> schema_lock(sqlite3Db._schema->mutex);
+				output << sqlite3Db._schema->tables.size() << " number of tables...";
+
+				for (auto table : sqlite3Db._schema->tables) {
 
 						table_name = table.first;
 						output << "Table: " <<table_name << '\n';
 						output << "With "<< table.second.size() << \
 						    " number of fields, which are:"<< '\n';
 
-						for (auto field : table.second) {
-								output << field << "  ";
+						for (const auto &field : table.second) {
+								output << field.name << "  ";
 						}
 						output << '\n'<< '\n';
 				}
@@ -444,7 +1011,14 @@ public:
 		 *
 		 * @return  True if the value is valid for the field given, false otherwise.
 		 */
-		bool isAffined(const std::string affinity, const std::string value_to_check);
+		static bool isAffined(const std::string affinity, const std::string value_to_check);
+
+		/*!
+		 * \brief Compares the value of some field to it's affinity, already resolved.
+		 *
+		 * @return  True if the value is valid for the affinity given, false otherwise.
+		 */
+		static bool isAffined(Affinity affinity, const std::string &value_to_check);
 
 		/*!
 		 * \brief Get status of the handler's connection
@@ -488,12 +1062,9 @@ public:
 		 *
 		 * @return     True if the string is a valid integer. False otherwise.
 		 */
-		bool isValidInt(const std::string &str)
+		static bool isValidInt(const std::string &str)
 		{
-				if(!str.empty())
-						return (find_if(str.begin(), str.end(), isInt) == str.end());
-				else
-						return false;
+				return validation::isDigits(str.data(), str.size());
 		};
 
 		/*!
@@ -503,23 +1074,153 @@ public:
 		 *
 		 * @return     True if the string is a valid real (float, double...). False otherwise.
 		 */
-		bool isValidReal(const std::string &str)
+		static bool isValidReal(const std::string &str)
 		{
-				if(!str.empty())
-						return (find_if(str.begin(), str.end(), isReal) == str.end());
-				else
-						return false;
+				return validation::isRealChars(str.data(), str.size());
 		};
 
 private:
-		int _rc;/*!< Flag that contains the status of the latest action executed.*/
+		friend class Cursor;
+		friend class PreparedQuery;
+		friend class Savepoint;
+		friend class Sqlite3DbPool;
+		friend class Transaction;
+
+		/*!
+		 * \brief Open a connection that works with a schema already loaded, without loading it.
+		 *
+		 * Used by the pool, whose handlers all share the schema loaded by the first one. It is
+		 * loaded again by updateHandler() once its schema version changes.
+		 *
+		 * @param schema Schema shared with the handler that loaded it.
+		 */
+		Sqlite3Db(std::string db_path, const OpenOptions &options, std::shared_ptr<SchemaInfo> schema);
+
+		/*!
+		 * \brief Statements used by transactions and savepoints, compiled once per connection.
+		 */
+		enum TransactionStatement {
+				begin_deferred,
+				begin_immediate,
+				begin_exclusive,
+				commit_transaction,
+				rollback_transaction,
+				open_savepoint,
+				release_savepoint,
+				rollback_savepoint,
+				num_transaction_statements
+		};
+
+		/*!
+		 * \brief Open the connection and apply the settings of the handler to it.
+		 *
+		 * @return EXIT_SUCCESS if the connection is open with every setting applied. Otherwise
+		 *  the connection is closed and EXIT_FAILURE is returned.
+		 */
+		bool openConnection(const char *db_path);
+
+		/*!
+		 * \brief Compile the transaction statements for the current connection.
+		 */
+		void prepareTransactionStatements();
+
+		/*!
+		 * \brief Finalize the transaction statements before the connection is closed.
+		 */
+		void finalizeTransactionStatements();
+
+		/*!
+		 * \brief Execute one of the precompiled transaction statements.
+		 *
+		 * @return EXIT_SUCCESS if the statement was executed. Otherwise EXIT_FAILURE is returned.
+		 */
+		bool runTransactionStatement(TransactionStatement statement);
+
+		/*!
+		 * \brief Bind a value given as text to a parameter of a statement.
+		 *
+		 * @param  stmt    Statement where the value is bound.
+		 * @param  index   Position of the parameter, starting at 1.
+		 * @param  value   Value to be bound. "NULL" binds a null value.
+		 * @param  as_text If true the value is always bound as text, otherwise numbers are bound
+		 *  as integers or reals.
+		 *
+		 * @return         The result code of the sqlite3_bind_*() call.
+		 */
+		static int bindValue(sqlite3_stmt *stmt, int index, const std::string &value, bool as_text);
+
+		/*!
+		 * \brief Load the description of the columns of a table, in one table_info pass.
+		 *
+		 * The columns are not locked, so they should not be the ones of the shared schema.
+		 *
+		 * @return EXIT_SUCCESS if the information was loaded. Otherwise EXIT_FAILURE is returned.
+		 */
+		bool loadTableInfo(const std::string &table_name, std::vector<ColumnDescriptor> &columns);
+
+		/*!
+		 * \brief Read PRAGMA data_version of the connection.
+		 *
+		 * @return EXIT_SUCCESS if the version was read. Otherwise EXIT_FAILURE is returned.
+		 */
+		bool readDataVersion(int64_t &version);
+
+		/*!
+		 * \brief Deliver the changes committed to their listeners, after a statement is done.
+		 */
+		void dispatchChanges(){
+				if (_notifier && this->_db != NULL)
+						_notifier->dispatch(_db);
+		};
+
+		/*!
+		 * \brief Sql composed for a select_query_param.
+		 */
+		struct SelectSql {
+				std::string sql;/*!< Text of the query.*/
+				std::vector<int> data_indexes;/*!< Indexes of the columns extracted.*/
+				size_t table_columns;/*!< Columns of the table when composed, all of them for "*".*/
+		};
+
+		/*!
+		 * \brief Compose the select query described by the options given.
+		 *
+		 * The query composed is remembered, so the same options find it already composed the
+		 *  next time.
+		 *
+		 * @param  select_options Options of the query. The order type is turned to uppercase.
+		 *
+		 * @return The query composed, or NULL if the options are not valid.
+		 */
+		std::shared_ptr<const SelectSql> composeSelectQuery(select_query_param &select_options);
+
+		/*!
+		 * \brief Execute a select query composed by composeSelectQuery().
+		 *
+		 * @return EXIT_SUCCESS if correct. Otherwise EXIT_FAILURE is returned.
+		 */
+		bool executeSelect(const SelectSql &select, std::vector<std::string> &data);
+
+		/*!
+		 * \brief Step a statement until it is done, extracting the columns asked for.
+		 *
+		 * @return EXIT_SUCCESS if the statement finished. Otherwise EXIT_FAILURE is returned.
+		 */
+		bool stepStatement(sqlite3_stmt *stmt, std::vector<std::string> &data, \
+		                   const std::vector<int> &indexes_stmt, bool verbose);
+
 		std::string _db_name;/*!< Relative path to database for file operations in string format.*/
 		const char *_db_path;/*!< Relative path to database for file operations.*/
-		sqlite3 *_db;/*!< Pointer to the database provided in the constructor.*/
-		const char *_sql;/*!< Pointer to the latest sql query in use.*/
-		sqlite3_stmt *_stmt;/*!< Pointer to the sql query output data.*/
-		const char *_zErrMsg = 0;/*!< Pointer to sql error message generated during the query execution.*/
-		DbTables _tables;/*!< Map containing the names of tables in database and their fields.*/
+		sqlite3 *_db = NULL;/*!< Pointer to the database provided in the constructor.*/
+		OpenOptions _options;/*!< Settings applied every time the connection is opened.*/
+		std::shared_ptr<SchemaInfo> _schema = std::make_shared<SchemaInfo>();/*!< Tables of the database and their fields, may be shared with other handlers.*/
+		StatementCache _stmt_cache;/*!< Prepared statements reused between executions.*/
+		std::unique_ptr<StatementProfiler> _profiler;/*!< Execution counters, only created with STATEMENT_STATS.*/
+		std::unique_ptr<ChangeNotifier> _notifier;/*!< Listeners of the changes of the tables, created with the first one.*/
+		std::vector<std::string> _warm_statements;/*!< Statements compiled on every connection.*/
+		std::mutex _select_mutex;/*!< Guards the select queries composed.*/
+		std::unordered_map<select_query_param, std::shared_ptr<const SelectSql>, SelectQueryHash> _select_queries;/*!< Select queries composed, by their options.*/
+		sqlite3_stmt *_txn_stmts[num_transaction_statements] = {};/*!< Precompiled transaction statements.*/
 
 };
 
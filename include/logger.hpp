@@ -0,0 +1,138 @@
+/*
+ * This file is part of Sqlite3Utils.
+ *
+ * Sqlite3Utils is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Sqlite3Utils is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Sqlite3Utils.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef SQLITE3LOGGER_H
+#define SQLITE3LOGGER_H
+
+#include <atomic>
+#include <memory>
+
+/*!
+ * \brief Lowest level compiled in: 0 Debug, 1 Info, 2 Warning, 3 Error, 4 Off. Messages below
+ *  it are removed by the compiler, arguments included. Set with the LOG_MIN_LEVEL cmake option.
+ */
+#ifndef SQLITE3UTILS_LOG_MIN_LEVEL
+#define SQLITE3UTILS_LOG_MIN_LEVEL 0
+#endif
+
+namespace handler {
+
+/*!
+ * \brief Importance of a log message.
+ */
+enum class LogLevel {
+		Debug,/*!< Details of the internal work of the library.*/
+		Info,/*!< Operations completed successfully.*/
+		Warning,/*!< Settings not applied as requested, or misuse that does not fail.*/
+		Error,/*!< Operations that failed.*/
+		Off/*!< No message has this level, used to disable logging.*/
+};
+
+/*! \brief Destination of the log messages of the library.
+ *
+ * A sink may be called from several threads at once, so it has to synchronize itself if it
+ * needs to.
+ */
+class LogSink {
+public:
+		virtual ~LogSink() = default;
+
+		/*!
+		 * \brief Write a message.
+		 *
+		 * @param level   Level of the message.
+		 * @param message Text of the message, without a trailing newline.
+		 */
+		virtual void write(LogLevel level, const char *message) = 0;
+};
+
+/*! \brief Sink writing errors and warnings to stderr and the rest to stdout. It is the default. */
+class ConsoleSink : public LogSink {
+public:
+		void write(LogLevel level, const char *message) override;
+};
+
+/*! \brief Sink discarding every message. */
+class NullSink : public LogSink {
+public:
+		void write(LogLevel, const char*) override {
+		};
+};
+
+namespace log {
+
+/*!
+ * \brief Lowest level written, checked before a message is formatted.
+ */
+extern std::atomic<int> runtime_level;
+
+/*!
+ * \brief Set the lowest level of the messages written. Default value is LogLevel::Warning.
+ */
+void setLevel(LogLevel level);
+
+/*!
+ * \brief Get the lowest level of the messages written.
+ */
+LogLevel getLevel();
+
+/*!
+ * \brief Set where the messages are written.
+ *
+ * @param sink Destination of the messages. NULL discards them.
+ */
+void setSink(std::shared_ptr<LogSink> sink);
+
+/*!
+ * \brief Check if a message of the level given would be written.
+ */
+inline bool enabled(LogLevel level){
+		return static_cast<int>(level) >= SQLITE3UTILS_LOG_MIN_LEVEL && \
+		       static_cast<int>(level) >= runtime_level.load(std::memory_order_relaxed);
+}
+
+/*!
+ * \brief Format a message like printf() and give it to the sink.
+ *
+ * Use the SQLITE3UTILS_LOG_* macros instead, which skip the formatting when the level is
+ * not enabled.
+ */
+void write(LogLevel level, const char *format, ...)
+#if defined(__GNUC__) || defined(__clang__)
+__attribute__((format(printf, 2, 3)))
+#endif
+;
+
+} // namespace log
+
+} // namespace handler
+
+/* The level is checked before the arguments are evaluated, so disabled messages cost a
+ * comparison, or nothing when they are below the compile time minimum. */
+#define SQLITE3UTILS_LOG(level, ...) \
+		do { \
+				if (handler::log::enabled(level)) \
+						handler::log::write(level, __VA_ARGS__); \
+		} while (0)
+
+#define SQLITE3UTILS_LOG_DEBUG(...) SQLITE3UTILS_LOG(handler::LogLevel::Debug, __VA_ARGS__)
+#define SQLITE3UTILS_LOG_INFO(...) SQLITE3UTILS_LOG(handler::LogLevel::Info, __VA_ARGS__)
+#define SQLITE3UTILS_LOG_WARNING(...) SQLITE3UTILS_LOG(handler::LogLevel::Warning, __VA_ARGS__)
+#define SQLITE3UTILS_LOG_ERROR(...) SQLITE3UTILS_LOG(handler::LogLevel::Error, __VA_ARGS__)
+
+#endif // SQLITE3LOGGER_H
@@ -0,0 +1,102 @@
+/*
+ * This file is part of Sqlite3Utils.
+ *
+ * Sqlite3Utils is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Sqlite3Utils is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Sqlite3Utils.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef SQLITE3NUMERICVALIDATION_H
+#define SQLITE3NUMERICVALIDATION_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "column_descriptor.hpp"
+
+namespace handler {
+
+/*!
+ * \brief Instruction set used to check the characters of numeric values.
+ */
+enum class SimdLevel {
+		Scalar,/*!< One character at a time, through a lookup table.*/
+		SSE2,/*!< 16 characters at a time.*/
+		AVX2/*!< 32 characters at a time.*/
+};
+
+/*! \brief Checks of the characters of numeric values, in bulk.
+ *
+ * The checks are the ones of Sqlite3Db::isValidInt() and Sqlite3Db::isValidReal(): an integer
+ * is a non empty run of digits, and a real is a non empty run of digits, dots and commas.
+ * Values at least as long as a vector register are checked with SSE2 or AVX2 when the
+ * processor has them, which is found out at runtime, and shorter values through a lookup
+ * table. Values are never read past their end.
+ */
+namespace validation {
+
+/*!
+ * \brief Get the instruction set used by the checks.
+ */
+SimdLevel getSimdLevel();
+
+/*!
+ * \brief Set the instruction set used by the checks, mainly to compare them.
+ *
+ * @param  level Instruction set wanted. The best one of the processor is used if it does not
+ *  support the one given.
+ *
+ * @return       The instruction set that will be used.
+ */
+SimdLevel setSimdLevel(SimdLevel level);
+
+/*!
+ * \brief Check if a text is a valid integer: not empty and only digits.
+ */
+bool isDigits(const char *text, size_t length);
+
+/*!
+ * \brief Check if a text is a valid real: not empty and only digits, dots and commas.
+ */
+bool isRealChars(const char *text, size_t length);
+
+/*!
+ * \brief Check a whole column of values against an affinity.
+ *
+ * The affinity is resolved once for the column, and each value is checked as
+ * Sqlite3Db::isAffined() would: INTEGER values must be integers, REAL and NUMERIC values
+ * reals, NULL values the text "NULL", and any other affinity accepts everything.
+ *
+ * @param  affinity Affinity of the column, as returned by Sqlite3Db::getAffinity().
+ * @param  values   Values of the column.
+ * @param  invalid  Where the positions of the values that are not valid are stored. Its
+ *  previous content is discarded.
+ *
+ * @return          The number of values that are not valid.
+ */
+size_t validateColumn(const std::string &affinity, const std::vector<std::string> &values, \
+                      std::vector<size_t> &invalid);
+
+/*!
+ * \brief Check a whole column of values against an affinity already resolved.
+ *
+ * @return The number of values that are not valid.
+ */
+size_t validateColumn(Affinity affinity, const std::vector<std::string> &values, \
+                      std::vector<size_t> &invalid);
+
+} // namespace validation
+
+} // namespace handler
+
+#endif // SQLITE3NUMERICVALIDATION_H
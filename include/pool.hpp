@@ -0,0 +1,216 @@
+/*
+ * This file is part of Sqlite3Utils.
+ *
+ * Sqlite3Utils is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Sqlite3Utils is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Sqlite3Utils.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef SQLITE3POOL_H
+#define SQLITE3POOL_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "handler.hpp"
+
+namespace handler {
+
+class Sqlite3DbPool;
+
+/*!
+ * \brief Counters describing the usage of a Sqlite3DbPool.
+ */
+struct PoolStats {
+		uint64_t acquisitions = 0;/*!< Number of handlers handed out.*/
+		uint64_t waits = 0;/*!< Number of acquisitions that found no idle handler and had to wait.*/
+		uint64_t timeouts = 0;/*!< Number of acquisitions that gave up before a handler was free.*/
+		uint64_t total_wait_ns = 0;/*!< Time spent waiting for a handler, in nanoseconds.*/
+		uint64_t max_wait_ns = 0;/*!< Longest wait for a handler, in nanoseconds.*/
+		size_t size = 0;/*!< Number of handlers of the pool.*/
+		size_t idle = 0;/*!< Number of handlers not leased at the moment.*/
+};
+
+/*! \brief Lease over a handler obtained from a Sqlite3DbPool.
+ *
+ * While the lease is alive the handler is reserved for its owner, which can use it as a
+ * pointer to a Sqlite3Db. The handler goes back to the pool when the lease is destroyed or
+ * release() is called. A lease must not outlive its pool.
+ */
+class PooledDb {
+public:
+		PooledDb() = default;
+		~PooledDb();
+
+		PooledDb(const PooledDb&) = delete;
+		PooledDb& operator=(const PooledDb&) = delete;
+		PooledDb(PooledDb &&other) noexcept;
+		PooledDb& operator=(PooledDb &&other) noexcept;
+
+		/*!
+		 * \brief Get the handler reserved by the lease.
+		 *
+		 * @return The handler, or NULL if the lease is empty.
+		 */
+		Sqlite3Db *get() const {
+				return _db;
+		};
+
+		Sqlite3Db *operator->() const {
+				return _db;
+		};
+
+		Sqlite3Db &operator*() const {
+				return *_db;
+		};
+
+		explicit operator bool() const {
+				return _db != NULL;
+		};
+
+		/*!
+		 * \brief Give the handler back to the pool before the lease is destroyed.
+		 */
+		void release();
+
+private:
+		friend class Sqlite3DbPool;
+
+		PooledDb(Sqlite3DbPool *pool, Sqlite3Db *db) : _pool(pool), _db(db) {
+		};
+
+		Sqlite3DbPool *_pool = NULL;/*!< Pool the handler belongs to.*/
+		Sqlite3Db *_db = NULL;/*!< Handler reserved by the lease.*/
+};
+
+/*! \brief Fixed set of handlers connected to the same database file.
+ *
+ * Each handler has its own connection and statement cache, so threads holding different
+ * leases run their queries in parallel without any other lock. The database is switched to
+ * WAL journal mode, where readers do not block each other nor the writer, and a busy
+ * timeout is set so writers wait for each other instead of failing. The schema is loaded
+ * once and shared by all the handlers: a table created through one lease is known by the
+ * rest.
+ *
+ * The pool needs a database file, since every connection to ":memory:" opens a different
+ * database.
+ *
+ * \include pool.cpp
+ */
+class Sqlite3DbPool {
+public:
+		/*!
+		 * \brief Open the handlers of the pool.
+		 *
+		 * @param db_path         Path to the database file. It is created if it does not exist.
+		 * @param size            Number of handlers, at least 1.
+		 * @param busy_timeout_ms Time a connection waits for a lock held by another before
+		 *  failing with SQLITE_BUSY. Default value is 5000.
+		 */
+		Sqlite3DbPool(std::string db_path, size_t size, int busy_timeout_ms = 5000);
+
+		/*!
+		 * \brief Open the handlers of the pool with the settings given.
+		 *
+		 * @param db_path Path to the database file. It is created if it does not exist.
+		 * @param size    Number of handlers, at least 1.
+		 * @param options Settings applied to every connection. The journal mode is always WAL.
+		 *
+		 * @overload
+		 */
+		Sqlite3DbPool(std::string db_path, size_t size, OpenOptions options);
+
+		/*!
+		 * \brief Close every handler. All the leases must have been released.
+		 */
+		~Sqlite3DbPool();
+
+		Sqlite3DbPool(const Sqlite3DbPool&) = delete;
+		Sqlite3DbPool& operator=(const Sqlite3DbPool&) = delete;
+
+		/*!
+		 * \brief Get a handler, waiting for one to be released if all of them are leased.
+		 *
+		 * @return The lease over the handler.
+		 */
+		PooledDb acquire();
+
+		/*!
+		 * \brief Get a handler, waiting at most the time given.
+		 *
+		 * @param  timeout Maximum time to wait for a handler to be released.
+		 *
+		 * @return         The lease over the handler. It is empty if the time ran out.
+		 */
+		PooledDb acquire(std::chrono::milliseconds timeout);
+
+		/*!
+		 * \brief Get a handler only if one is idle.
+		 *
+		 * @return The lease over the handler. It is empty if all of them are leased.
+		 */
+		PooledDb tryAcquire();
+
+		/*!
+		 * \brief Get the number of handlers of the pool.
+		 */
+		size_t size() const {
+				return _handlers.size();
+		};
+
+		/*!
+		 * \brief Check if every handler of the pool is connected.
+		 *
+		 * @return True if the pool can be used. False otherwise.
+		 */
+		bool isConnected() const;
+
+		/*!
+		 * \brief Get the usage counters of the pool.
+		 *
+		 * @return Acquisitions, waits and occupation of the pool.
+		 */
+		PoolStats getStats() const;
+
+		/*!
+		 * \brief Set the acquisition and wait counters back to 0.
+		 */
+		void resetStats();
+
+private:
+		friend class PooledDb;
+
+		/*!
+		 * \brief Take an idle handler, the mutex of the pool must be locked.
+		 */
+		PooledDb take(std::chrono::steady_clock::time_point start, bool waited);
+
+		/*!
+		 * \brief Put a handler back in the idle list and wake up a waiting thread.
+		 */
+		void giveBack(Sqlite3Db *db);
+
+		std::vector<std::unique_ptr<Sqlite3Db> > _handlers;/*!< Handlers owned by the pool.*/
+		std::vector<Sqlite3Db*> _idle;/*!< Handlers not leased at the moment.*/
+		mutable std::mutex _mutex;/*!< Guards the idle list and the counters.*/
+		std::condition_variable _released;/*!< Signaled when a handler goes back to the pool.*/
+		PoolStats _stats;/*!< Usage counters.*/
+};
+
+} // namespace handler
+
+#endif // SQLITE3POOL_H
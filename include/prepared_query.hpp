@@ -0,0 +1,201 @@
+/*
+ * This file is part of Sqlite3Utils.
+ *
+ * Sqlite3Utils is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Sqlite3Utils is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Sqlite3Utils.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef SQLITE3PREPAREDQUERY_H
+#define SQLITE3PREPAREDQUERY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <sqlite3.h>
+#include <string_view>
+#include <type_traits>
+#include "cursor.hpp"
+#include "statement_cache.hpp"
+
+namespace handler {
+
+/*! \brief Compiled statement that is bound, stepped and reset by its owner.
+ *
+ * Unlike executeQuery(), values are bound and read in their own type, so a loop running the
+ * same statement many times neither compiles it again nor converts numbers to text. The
+ * statement is taken from the statement cache of the handler, and goes back to it when the
+ * query is destroyed, so a query must not outlive the handler that prepared it. A query is
+ * not thread safe, each thread should prepare its own one.
+ *
+ * Parameters are numbered from 1, as in sqlite3_bind_*(), and columns from 0. Named
+ * parameters (":name", "@name" or "$name") can be bound by name, prefix included.
+ *
+ * \include preparedQuery.cpp
+ */
+class PreparedQuery {
+public:
+		PreparedQuery() = default;
+
+		PreparedQuery(PreparedQuery&&) = default;
+		PreparedQuery& operator=(PreparedQuery&&) = default;
+
+		/*!
+		 * \brief Check if the query has a statement to run.
+		 *
+		 * @return False if the query could not be compiled.
+		 */
+		bool isValid() const {
+				return static_cast<bool>(_stmt);
+		};
+
+		/*!
+		 * \brief Bind a value to a parameter.
+		 *
+		 * Text and blobs are copied by sqlite3, so they can be destroyed right after binding.
+		 * Integers of any type, such as sqlite3_int64 or size_t, are bound as 64 bit integers.
+		 *
+		 * @param  index Position of the parameter, starting at 1.
+		 * @param  value Value bound. nullptr binds NULL.
+		 *
+		 * @return EXIT_SUCCESS if the value was bound. Otherwise EXIT_FAILURE is returned.
+		 */
+		template <typename T, std::enable_if_t<std::is_integral_v<T> && !std::is_same_v<T, bool>, int> = 0>
+		bool bind(int index, T value){
+				return bindInteger(index, static_cast<int64_t>(value));
+		};
+		bool bind(int index, double value);
+		bool bind(int index, std::string_view value);
+		bool bind(int index, const char *value);
+		bool bind(int index, BlobView value);
+		bool bind(int index, std::nullptr_t);
+
+		/*!
+		 * \brief Bind a value to a named parameter.
+		 *
+		 * @param  name  Name of the parameter, with its prefix, e.g. ":id".
+		 * @param  value Value bound, of any type accepted by bind(int, ...).
+		 *
+		 * @return EXIT_SUCCESS if the value was bound. EXIT_FAILURE if there is no parameter
+		 *  with that name or the value could not be bound.
+		 */
+		template <typename T>
+		bool bind(const char *name, T value){
+				return bind(parameterIndex(name), value);
+		};
+
+		/*!
+		 * \brief Set every parameter back to NULL.
+		 */
+		void clearBindings();
+
+		/*!
+		 * \brief Run the statement until it has a row or is done.
+		 *
+		 * @return True if a row is available through the getters. False when the statement is
+		 *  done or failed, which can be told apart with getResultCode().
+		 */
+		bool step();
+
+		/*!
+		 * \brief Leave the statement ready to be run again. The values bound are kept.
+		 */
+		void reset();
+
+		/*!
+		 * \brief Get the sqlite3 result code of the latest step.
+		 *
+		 * @return SQLITE_ROW while rows are available, SQLITE_DONE once the statement finished,
+		 *  or the error code of the step that failed.
+		 */
+		int getResultCode() const {
+				return _rc;
+		};
+
+		/*!
+		 * \brief Get the number of parameters of the statement.
+		 */
+		int parameterCount() const {
+				return sqlite3_bind_parameter_count(_stmt.get());
+		};
+
+		/*!
+		 * \brief Get the position of a named parameter.
+		 *
+		 * @return The position of the parameter, or 0 if there is none with that name.
+		 */
+		int parameterIndex(const char *name) const {
+				return sqlite3_bind_parameter_index(_stmt.get(), name);
+		};
+
+		/*!
+		 * \brief Get the current row, valid until the next step or reset.
+		 */
+		const RowView &row() const {
+				return _row;
+		};
+
+		int columnCount() const {
+				return _row.columnCount();
+		};
+
+		bool isNull(int column) const {
+				return _row.isNull(column);
+		};
+
+		int64_t getInt64(int column) const {
+				return _row.getInt64(column);
+		};
+
+		double getDouble(int column) const {
+				return _row.getDouble(column);
+		};
+
+		/*!
+		 * \brief Get the value of a column as text, valid until the next step or reset.
+		 */
+		std::string_view getText(int column) const {
+				return _row.getText(column);
+		};
+
+		/*!
+		 * \brief Get the value of a column as a blob, valid until the next step or reset.
+		 */
+		BlobView getBlob(int column) const {
+				return _row.getBlob(column);
+		};
+
+private:
+		friend class Sqlite3Db;
+
+		PreparedQuery(CachedStatement &&stmt, Sqlite3Db *handler);
+
+		/*!
+		 * \brief Bind an integer of any type through sqlite3_bind_int64().
+		 */
+		bool bindInteger(int index, int64_t value);
+
+		/*!
+		 * \brief Report the result of a bind call.
+		 */
+		bool checkBind(int rc, int index);
+
+		CachedStatement _stmt;/*!< Statement run by the query.*/
+		sqlite3 *_db = NULL;/*!< Connection of the statement, used to report errors.*/
+		Sqlite3Db *_handler = NULL;/*!< Handler that prepared the query, told when a statement is done.*/
+		RowView _row;/*!< View over the current row.*/
+		int _rc = SQLITE_OK;/*!< Result code of the latest step.*/
+};
+
+} // namespace handler
+
+#endif // SQLITE3PREPAREDQUERY_H
@@ -58,7 +58,9 @@ namespace query {
     const std::string before            = " BEFORE ";
     const std::string between           = " BETWEEN ";
     const std::string count             = " COUNT ";
+    const std::string deferred          = " DEFERRED ";
     const std::string distinct          = " DISTINCT ";
+    const std::string exclusive         = " EXCLUSIVE ";
     const std::string exists            = " EXISTS ";
     const std::string for_              = " FOR ";
     const std::string for_each          = " FOR EACH ";
@@ -75,8 +77,18 @@ namespace query {
     const std::string glob(const std::string pattern);
     const std::string group_by          = " GROUP BY ";
     const std::string having            = " HAVING ";
+    const std::string immediate         = " IMMEDIATE ";
     const std::string in                = " IN ";
 
+    /*!
+     * \brief Generates a journal_mode setting used in PRAGMA statements.
+     *
+     * @param  mode The journal mode to set: DELETE, TRUNCATE, PERSIST, MEMORY, WAL or OFF.
+     *
+     * @return      The composed journal_mode setting. "journal_mode=[mode]"
+     */
+    const std::string journal_mode(const std::string mode);
+
     /*!
      * \brief generates a LIKE sqlite3 clause with the pattern given.
      *
@@ -110,6 +122,16 @@ namespace query {
     const std::string or_               = " OR ";
     const std::string order_by          = " ORDER BY ";
     const std::string set               = " SET ";
+
+    /*!
+     * \brief Generates a setting used in PRAGMA statements.
+     *
+     * @param  name  The name of the setting, such as synchronous or cache_size.
+     * @param  value The value given to the setting.
+     *
+     * @return       The composed setting. "[name]=[value]"
+     */
+    const std::string setting(const std::string name, const std::string value);
     const std::string sum               = " SUM ";
 
     /*!
@@ -0,0 +1,199 @@
+/*
+ * This file is part of Sqlite3Utils.
+ *
+ * Sqlite3Utils is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Sqlite3Utils is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Sqlite3Utils.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef SQLITE3RESULTSET_H
+#define SQLITE3RESULTSET_H
+
+#include <cstdint>
+#include <sqlite3.h>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace handler {
+
+/*!
+ * \brief Storage type of a column of a ResultSet.
+ */
+enum class ColumnType {
+		Integer,/*!< 64 bit signed integers.*/
+		Real,/*!< Double precision floating point numbers.*/
+		Text,/*!< UTF-8 text.*/
+		Blob,/*!< Binary data.*/
+		Null/*!< Every value of the column is NULL, so no storage was chosen.*/
+};
+
+/*! \brief Typed, column oriented result of a query.
+ *
+ * Each column keeps its values in contiguous storage chosen from its declared type (or from
+ * its first non NULL value when it has none): an array of int64_t or double for numbers, or a
+ * single buffer indexed by offsets for text and blobs. NULL values are marked in a bitmap, so
+ * they do not shift the rest of the row as in the string based selectRecords().
+ *
+ * When a value does not fit the storage of its column, the column is converted once: an
+ * integer column becomes a real one when a real value appears, and a numeric column becomes
+ * a text one when a text or blob value appears.
+ *
+ * \include selectResultSet.cpp
+ */
+class ResultSet {
+public:
+		ResultSet() = default;
+
+		/*!
+		 * \brief Step a statement until it is done, storing every row produced.
+		 *
+		 * Any previous content of the result set is discarded first.
+		 *
+		 * @param  stmt Statement ready to be stepped.
+		 *
+		 * @return      The sqlite3 result code of the last step, SQLITE_DONE if every row was
+		 *  loaded.
+		 */
+		int load(sqlite3_stmt *stmt);
+
+		/*!
+		 * \brief Remove every row and column.
+		 */
+		void clear();
+
+		/*!
+		 * \brief Get the number of rows stored.
+		 */
+		size_t rowCount() const {
+				return _rows;
+		};
+
+		/*!
+		 * \brief Get the number of columns of the result.
+		 */
+		size_t columnCount() const {
+				return _columns.size();
+		};
+
+		/*!
+		 * \brief Get the name of a column.
+		 *
+		 * @param  column Position of the column.
+		 *
+		 * @return        The name given by sqlite3 to the column.
+		 */
+		const std::string &columnName(size_t column) const {
+				return _columns[column].name;
+		};
+
+		/*!
+		 * \brief Get the position of a column from its name.
+		 *
+		 * @param  name Name of the column.
+		 *
+		 * @return      The position of the column, or -1 if no column has that name.
+		 */
+		int columnIndex(std::string_view name) const;
+
+		/*!
+		 * \brief Get the storage type of a column.
+		 *
+		 * @param  column Position of the column.
+		 */
+		ColumnType columnType(size_t column) const {
+				return _columns[column].type;
+		};
+
+		/*!
+		 * \brief Check if a value is NULL.
+		 *
+		 * @param  row    Position of the row.
+		 * @param  column Position of the column.
+		 *
+		 * @return        True if the value is NULL. False otherwise.
+		 */
+		bool isNull(size_t row, size_t column) const {
+				return (_columns[column].nulls[row >> 6] >> (row & 63)) & 1;
+		};
+
+		/*!
+		 * \brief Get a value as an integer. Real values are truncated, others return 0.
+		 */
+		int64_t getInt64(size_t row, size_t column) const;
+
+		/*!
+		 * \brief Get a value as a real number. Integer values are converted, others return 0.
+		 */
+		double getDouble(size_t row, size_t column) const;
+
+		/*!
+		 * \brief Get a text or blob value without copying it.
+		 *
+		 * The view is valid while the result set is alive and not loaded again. Numeric columns
+		 * return an empty view.
+		 */
+		std::string_view getText(size_t row, size_t column) const;
+
+		/*!
+		 * \brief Get the contiguous storage of an integer column.
+		 *
+		 * @param  column Position of the column.
+		 *
+		 * @return        One value per row (0 for NULL values). Empty if the column is not an
+		 *  integer column.
+		 */
+		const std::vector<int64_t> &integers(size_t column) const {
+				return _columns[column].integers;
+		};
+
+		/*!
+		 * \brief Get the contiguous storage of a real column.
+		 *
+		 * @param  column Position of the column.
+		 *
+		 * @return        One value per row (0 for NULL values). Empty if the column is not a
+		 *  real column.
+		 */
+		const std::vector<double> &reals(size_t column) const {
+				return _columns[column].reals;
+		};
+
+private:
+		struct Column {
+				std::string name;/*!< Name of the column.*/
+				ColumnType type = ColumnType::Null;/*!< Storage chosen for the column.*/
+				std::vector<int64_t> integers;/*!< Values of an integer column.*/
+				std::vector<double> reals;/*!< Values of a real column.*/
+				std::string arena;/*!< Bytes of every value of a text or blob column.*/
+				std::vector<size_t> offsets;/*!< Start of each value in the arena, plus the end.*/
+				std::vector<uint64_t> nulls;/*!< Bitmap of NULL values.*/
+		};
+
+		/*!
+		 * \brief Store the value of a column of the current row of a statement.
+		 */
+		void appendValue(Column &column, sqlite3_stmt *stmt, int index);
+
+		/*!
+		 * \brief Change the storage of a column, converting the values already stored.
+		 */
+		void setType(Column &column, ColumnType type);
+
+		std::vector<Column> _columns;/*!< Columns of the result.*/
+		size_t _rows = 0;/*!< Number of rows loaded.*/
+};
+
+} // namespace handler
+
+#endif // SQLITE3RESULTSET_H
@@ -0,0 +1,140 @@
+/*
+ * This file is part of Sqlite3Utils.
+ *
+ * Sqlite3Utils is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Sqlite3Utils is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Sqlite3Utils.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef SQLITE3ROWMAPPING_H
+#define SQLITE3ROWMAPPING_H
+
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "cursor.hpp"
+
+namespace handler {
+
+/*!
+ * \brief Reader of a column as a value of type T.
+ *
+ * Integers (bool included) are read with sqlite3_column_int64(), floating point numbers with
+ * sqlite3_column_double(), std::string with sqlite3_column_text() and
+ * std::vector<unsigned char> with sqlite3_column_blob(). NULL is read as 0 or as an empty
+ * value, unless the type is an std::optional, which is left empty instead.
+ */
+template <typename T, typename Enable = void>
+struct ColumnValue {
+		static_assert(sizeof(T) == 0, "There is no column reader for this type");
+};
+
+template <typename T>
+struct ColumnValue<T, std::enable_if_t<std::is_integral<T>::value> > {
+		static T read(const RowView &row, int column){
+				return static_cast<T>(row.getInt64(column));
+		};
+};
+
+template <typename T>
+struct ColumnValue<T, std::enable_if_t<std::is_floating_point<T>::value> > {
+		static T read(const RowView &row, int column){
+				return static_cast<T>(row.getDouble(column));
+		};
+};
+
+template <>
+struct ColumnValue<std::string> {
+		static std::string read(const RowView &row, int column){
+				return std::string(row.getText(column));
+		};
+};
+
+template <>
+struct ColumnValue<std::vector<unsigned char> > {
+		static std::vector<unsigned char> read(const RowView &row, int column){
+				BlobView blob = row.getBlob(column);
+				return std::vector<unsigned char>(blob.data, blob.data + blob.size);
+		};
+};
+
+template <typename T>
+struct ColumnValue<std::optional<T> > {
+		static std::optional<T> read(const RowView &row, int column){
+				if (row.isNull(column))
+						return std::nullopt;
+				return ColumnValue<T>::read(row, column);
+		};
+};
+
+/*!
+ * \brief Columns a struct is filled from, declared by the user.
+ *
+ * Specialize it with the pointers to the members filled from each column, in the order the
+ * query selects them:
+ *
+ * \code
+ * namespace handler {
+ * template <> struct RowMapping<Employee> {
+ *     static constexpr auto fields = std::make_tuple(&Employee::id, &Employee::name);
+ * };
+ * }
+ * \endcode
+ */
+template <typename T>
+struct RowMapping;
+
+/*!
+ * \brief Reader of a whole row into a struct declared with RowMapping.
+ */
+template <typename T>
+struct RowValue {
+		static constexpr size_t columns = std::tuple_size<std::decay_t<decltype(RowMapping<T>::fields)> >::value;
+
+		static void read(const RowView &row, T &value){
+				read(row, value, std::make_index_sequence<columns>());
+		};
+
+private:
+		template <size_t... I>
+		static void read(const RowView &row, T &value, std::index_sequence<I...>){
+				((value.*std::get<I>(RowMapping<T>::fields) = \
+				  ColumnValue<std::decay_t<decltype(value.*std::get<I>(RowMapping<T>::fields))> >::read(row, I)), ...);
+		};
+};
+
+/*!
+ * \brief Reader of a whole row into a tuple, one column per element.
+ */
+template <typename... Ts>
+struct RowValue<std::tuple<Ts...> > {
+		static constexpr size_t columns = sizeof...(Ts);
+
+		static void read(const RowView &row, std::tuple<Ts...> &value){
+				read(row, value, std::index_sequence_for<Ts...>());
+		};
+
+private:
+		template <size_t... I>
+		static void read(const RowView &row, std::tuple<Ts...> &value, std::index_sequence<I...>){
+				((std::get<I>(value) = ColumnValue<Ts>::read(row, I)), ...);
+		};
+};
+
+} // namespace handler
+
+#endif // SQLITE3ROWMAPPING_H
@@ -0,0 +1,191 @@
+/*
+ * This file is part of Sqlite3Utils.
+ *
+ * Sqlite3Utils is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Sqlite3Utils is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Sqlite3Utils.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef SQLITE3STATEMENTCACHE_H
+#define SQLITE3STATEMENTCACHE_H
+
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <sqlite3.h>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace handler {
+
+class StatementCache;
+
+/*!
+ * \brief Counters describing the usage of a StatementCache.
+ */
+struct StatementCacheStats {
+		uint64_t hits = 0;/*!< Number of statements served from the cache.*/
+		uint64_t misses = 0;/*!< Number of statements that had to be compiled.*/
+		uint64_t evictions = 0;/*!< Number of statements finalized to make room for new ones.*/
+		size_t size = 0;/*!< Number of statements currently stored.*/
+		size_t capacity = 0;/*!< Maximum number of statements stored.*/
+};
+
+/*! \brief Lease over a prepared statement obtained from a StatementCache.
+ *
+ * While the lease is alive the statement is reserved for its owner. When the lease is
+ * destroyed (or release() is called) the statement is reset, its bindings are cleared and
+ * it is handed back to the cache. Statements that could not be cached are finalized instead.
+ */
+class CachedStatement {
+public:
+		CachedStatement() = default;
+		~CachedStatement();
+
+		CachedStatement(const CachedStatement&) = delete;
+		CachedStatement& operator=(const CachedStatement&) = delete;
+		CachedStatement(CachedStatement &&other) noexcept;
+		CachedStatement& operator=(CachedStatement &&other) noexcept;
+
+		/*!
+		 * \brief Get the statement handled by the lease.
+		 *
+		 * @return The sqlite3 statement, or NULL if the lease is empty.
+		 */
+		sqlite3_stmt *get() const {
+				return _stmt;
+		};
+
+		explicit operator bool() const {
+				return _stmt != NULL;
+		};
+
+		/*!
+		 * \brief Give the statement back to the cache before the lease is destroyed.
+		 */
+		void release();
+
+private:
+		friend class StatementCache;
+
+		CachedStatement(StatementCache *cache, sqlite3_stmt *stmt, void *entry) :
+				_cache(cache), _stmt(stmt), _entry(entry) {
+		};
+
+		StatementCache *_cache = NULL;/*!< Cache the statement belongs to.*/
+		sqlite3_stmt *_stmt = NULL;/*!< Statement reserved by the lease.*/
+		void *_entry = NULL;/*!< Cache slot of the statement, NULL if it is not cached.*/
+};
+
+/*! \brief Bounded LRU cache of prepared statements keyed by their SQL text.
+ *
+ * Compiling a statement with sqlite3_prepare_v2() usually costs more than running it, so
+ * the handler keeps the most recently used statements alive and reuses them with
+ * sqlite3_reset() and sqlite3_clear_bindings(). When a statement is requested while it is
+ * already in use, a private copy is compiled and finalized once it is released.
+ *
+ * The cache can be used from several threads at once. Statements are compiled without
+ * holding its lock.
+ */
+class StatementCache {
+public:
+		/*!
+		 * \brief Constructor of the cache.
+		 *
+		 * @param capacity Maximum number of statements kept alive. 0 disables the caching.
+		 */
+		explicit StatementCache(size_t capacity = 64);
+
+		/*!
+		 * \brief Destructor, finalizes every statement stored.
+		 */
+		~StatementCache();
+
+		StatementCache(const StatementCache&) = delete;
+		StatementCache& operator=(const StatementCache&) = delete;
+
+		/*!
+		 * \brief Get a prepared statement for the sql given, compiling it only if needed.
+		 *
+		 * @param  db  Connection used to compile the statement on a cache miss.
+		 * @param  sql Text of the statement. Only the first statement of the text is compiled.
+		 * @param  rc  Result code of sqlite3_prepare_v2(), SQLITE_OK on a cache hit.
+		 *
+		 * @return     The lease over the statement. It is empty if the compilation failed.
+		 */
+		CachedStatement acquire(sqlite3 *db, std::string_view sql, int &rc);
+
+		/*!
+		 * \brief Compile a statement and store it without using it.
+		 *
+		 * @param  db  Connection used to compile the statement.
+		 * @param  sql Text of the statement.
+		 *
+		 * @return     SQLITE_OK if the statement is stored, the sqlite3 error code otherwise.
+		 */
+		int warm(sqlite3 *db, std::string_view sql);
+
+		/*!
+		 * \brief Finalize every statement which is not in use and empty the cache.
+		 *
+		 * Statements leased at the moment of the call are finalized when they are released.
+		 */
+		void clear();
+
+		/*!
+		 * \brief Change the maximum number of statements stored, evicting if needed.
+		 *
+		 * @param capacity New capacity. 0 disables the caching.
+		 */
+		void setCapacity(size_t capacity);
+
+		/*!
+		 * \brief Get the usage counters of the cache.
+		 *
+		 * @return Hits, misses, evictions and occupation of the cache.
+		 */
+		StatementCacheStats getStats() const;
+
+		/*!
+		 * \brief Set the hit, miss and eviction counters back to 0.
+		 */
+		void resetStats();
+
+private:
+		friend class CachedStatement;
+
+		struct Entry {
+				std::string sql;/*!< Text used as key of the entry.*/
+				sqlite3_stmt *stmt;/*!< Compiled statement.*/
+				bool in_use;/*!< Whether a lease currently holds the statement.*/
+				bool detached;/*!< Whether the entry was removed from the cache while in use.*/
+		};
+		typedef std::list<Entry> EntryList;
+
+		void release(sqlite3_stmt *stmt, Entry *entry);
+		void evict();
+
+		EntryList _entries;/*!< Cached statements, most recently used first.*/
+		EntryList _detached;/*!< Entries cleared while leased, finalized on release.*/
+		std::unordered_map<std::string_view, EntryList::iterator> _index;/*!< Lookup by sql text.*/
+		mutable std::mutex _mutex;/*!< Guards the entries and the counters.*/
+		size_t _capacity;/*!< Maximum number of cached statements.*/
+		uint64_t _hits = 0;/*!< Statements served from the cache.*/
+		uint64_t _misses = 0;/*!< Statements compiled on request.*/
+		uint64_t _evictions = 0;/*!< Statements finalized to make room.*/
+};
+
+} // namespace handler
+
+#endif // SQLITE3STATEMENTCACHE_H
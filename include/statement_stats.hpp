@@ -0,0 +1,127 @@
+/*
+ * This file is part of Sqlite3Utils.
+ *
+ * Sqlite3Utils is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Sqlite3Utils is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Sqlite3Utils.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef SQLITE3STATEMENTSTATS_H
+#define SQLITE3STATEMENTSTATS_H
+
+#include <array>
+#include <cstdint>
+#include <mutex>
+#include <sqlite3.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace handler {
+
+/*!
+ * \brief Number of buckets of the latency histogram. Bucket i counts the executions that took
+ *  between 2^i and 2^(i+1) - 1 nanoseconds.
+ */
+constexpr size_t latency_buckets = 64;
+
+/*!
+ * \brief Execution counters of every statement sharing the same normalized sql.
+ */
+struct StatementStats {
+		std::string sql;/*!< Sql of the statements, with whitespace collapsed and literals replaced by "?".*/
+		uint64_t calls = 0;/*!< Number of executions.*/
+		uint64_t rows = 0;/*!< Rows returned by all the executions.*/
+		uint64_t total_ns = 0;/*!< Time spent running the statements, in nanoseconds.*/
+		uint64_t min_ns = 0;/*!< Fastest execution.*/
+		uint64_t max_ns = 0;/*!< Slowest execution.*/
+		uint64_t p50_ns = 0;/*!< Median execution time, rounded up to the end of its histogram bucket.*/
+		uint64_t p99_ns = 0;/*!< 99th percentile of the execution time, rounded like p50_ns.*/
+		std::array<uint64_t, latency_buckets> histogram{};/*!< Executions per log2 latency bucket.*/
+};
+
+/*! \brief Collector of the execution time of the statements run on a connection.
+ *
+ * The profiler registers itself with sqlite3_trace_v2(), so it sees every statement of the
+ * connection, including the ones compiled by sqlite3_exec(). Statements are grouped by their
+ * normalized sql, so the same query run with different literal values is counted once.
+ *
+ * Sqlite3Db only creates a profiler when the library is built with STATEMENT_STATS, otherwise
+ * no callback is registered and nothing is measured.
+ */
+class StatementProfiler {
+public:
+		StatementProfiler() = default;
+
+		StatementProfiler(const StatementProfiler&) = delete;
+		StatementProfiler& operator=(const StatementProfiler&) = delete;
+
+		/*!
+		 * \brief Start measuring the statements of a connection.
+		 *
+		 * @param db Connection traced. The profiler must outlive it or be detached first.
+		 */
+		void attach(sqlite3 *db);
+
+		/*!
+		 * \brief Stop measuring the statements of a connection.
+		 */
+		static void detach(sqlite3 *db);
+
+		/*!
+		 * \brief Get the counters of every statement measured so far.
+		 *
+		 * @return One entry per normalized sql, the ones that took more time in total first.
+		 */
+		std::vector<StatementStats> snapshot() const;
+
+		/*!
+		 * \brief Discard every counter.
+		 */
+		void reset();
+
+		/*!
+		 * \brief Normalize sql so statements differing only on literal values are grouped.
+		 *
+		 * Whitespace is collapsed and string, blob and numeric literals are replaced by "?".
+		 *
+		 * @param  sql Sql to be normalized.
+		 *
+		 * @return     The normalized sql.
+		 */
+		static std::string normalize(const char *sql);
+
+private:
+		/*! \brief Counters of one normalized sql. */
+		struct Entry {
+				uint64_t calls = 0;
+				uint64_t rows = 0;
+				uint64_t total_ns = 0;
+				uint64_t min_ns = UINT64_MAX;
+				uint64_t max_ns = 0;
+				std::array<uint64_t, latency_buckets> histogram{};
+		};
+
+		/*!
+		 * \brief Callback given to sqlite3_trace_v2().
+		 */
+		static int trace(unsigned type, void *context, void *statement, void *extra);
+
+		mutable std::mutex _mutex;/*!< Guards the counters, read from other threads.*/
+		std::unordered_map<std::string, Entry> _entries;/*!< Counters by normalized sql.*/
+		std::unordered_map<sqlite3_stmt*, uint64_t> _rows;/*!< Rows returned by statements not finished yet.*/
+};
+
+} // namespace handler
+
+#endif // SQLITE3STATEMENTSTATS_H
@@ -0,0 +1,374 @@
+/*
+ * This file is part of Sqlite3Utils.
+ *
+ * Sqlite3Utils is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Sqlite3Utils is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Sqlite3Utils.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef SQLITE3STATICQUERY_H
+#define SQLITE3STATICQUERY_H
+
+#include <cstddef>
+#include <string_view>
+
+namespace query {
+
+/*! \brief Queries composed by the compiler.
+ *
+ * The functions of this namespace are constexpr, so a query declared as
+ * "static constexpr auto" is written into the binary as a plain string: nothing is allocated
+ * nor concatenated when it is executed. The clauses are chained in the order sql expects them,
+ * and chaining them in any other order fails to compile.
+ *
+ * The queries convert to const char*, so they can be given to Sqlite3Db::executeQuery(), where
+ * their statement is compiled once and then taken from the statement cache.
+ *
+ * \include staticQuery.cpp
+ */
+namespace fixed {
+
+/*!
+ * \brief Fixed size text built at compile time.
+ *
+ * @tparam N Number of characters, without the terminating null character.
+ */
+template <size_t N>
+class Text {
+public:
+		constexpr Text() : _data{} {
+		}
+
+		/*!
+		 * \brief Copy a string literal.
+		 */
+		constexpr Text(const char (&text)[N + 1]) : _data{} {
+				for (size_t i = 0; i < N; ++i)
+						_data[i] = text[i];
+		}
+
+		/*!
+		 * \brief Append another text.
+		 *
+		 * @return A text holding this one followed by other.
+		 */
+		template <size_t M>
+		constexpr Text<N + M> operator+(const Text<M> &other) const {
+				Text<N + M> result;
+
+				for (size_t i = 0; i < N; ++i)
+						result._data[i] = _data[i];
+				for (size_t i = 0; i < M; ++i)
+						result._data[N + i] = other._data[i];
+				return result;
+		}
+
+		constexpr char operator[](size_t i) const {
+				return _data[i];
+		}
+
+		constexpr const char* c_str() const {
+				return _data;
+		}
+
+		constexpr std::string_view view() const {
+				return std::string_view(_data, N);
+		}
+
+		static constexpr size_t size() {
+				return N;
+		}
+
+private:
+		template <size_t> friend class Text;
+		template <unsigned long long> friend struct Number;
+
+		char _data[N + 1];/*!< Characters of the text, always null terminated.*/
+};
+
+/*!
+ * \brief Make a text from a string literal.
+ */
+template <size_t N>
+constexpr Text<N - 1> text(const char (&literal)[N]){
+		return Text<N - 1>(literal);
+}
+
+/*!
+ * \brief Number of decimal digits of a value.
+ */
+constexpr size_t digits(unsigned long long value){
+		return (value < 10) ? 1 : 1 + digits(value / 10);
+}
+
+/*!
+ * \brief Decimal text of a value known at compile time.
+ */
+template <unsigned long long Value>
+struct Number {
+		static constexpr Text<digits(Value)> text(){
+				Text<digits(Value)> result;
+				unsigned long long rest = Value;
+
+				for (size_t i = digits(Value); i > 0; --i, rest /= 10)
+						result._data[i - 1] = static_cast<char>('0' + rest % 10);
+				return result;
+		}
+};
+
+/*!
+ * \brief Join texts with ", " between them.
+ */
+template <size_t N>
+constexpr Text<N> list(const Text<N> &item){
+		return item;
+}
+
+template <size_t N, size_t M, typename... Rest>
+constexpr auto list(const Text<N> &first, const Text<M> &second, const Rest&... rest){
+		return list(first + text(", ") + second, rest...);
+}
+
+/*!
+ * \brief "?" placeholders separated by ", ".
+ *
+ * @tparam Count Number of placeholders, at least one.
+ */
+template <size_t Count>
+constexpr auto placeholders(){
+		static_assert(Count > 0, "At least one placeholder is needed");
+		if constexpr (Count == 1)
+				return text("?");
+		else
+				return placeholders<Count - 1>() + text(", ?");
+}
+
+/*!
+ * \brief Last clause written to a query, which tells the clauses that can follow it.
+ */
+enum class Clause {
+		Select,/*!< "SELECT columns", FROM can follow.*/
+		From,/*!< "SELECT ... FROM table".*/
+		Where,/*!< "SELECT ... FROM ... WHERE condition".*/
+		GroupBy,/*!< "... GROUP BY columns".*/
+		Having,/*!< "... GROUP BY ... HAVING condition".*/
+		OrderBy,/*!< "... ORDER BY columns".*/
+		Limit,/*!< "... LIMIT count".*/
+		Offset,/*!< "... LIMIT ... OFFSET count".*/
+		Update,/*!< "UPDATE table", SET must follow.*/
+		Set,/*!< "UPDATE ... SET columns", WHERE can follow.*/
+		Delete,/*!< "DELETE FROM table", WHERE can follow.*/
+		Complete/*!< Nothing else can be added.*/
+};
+
+/*!
+ * \brief Sql text of a query, whose type tracks the clauses that can still be added.
+ *
+ * Each clause returns a new query, with the text of the clause appended and Last set to it.
+ * Every method checks Last with static_assert, so a clause out of order is a compile error.
+ *
+ * @tparam N    Length of the sql text.
+ * @tparam Last Last clause written.
+ */
+template <size_t N, Clause Last>
+class StaticQuery {
+public:
+		constexpr explicit StaticQuery(const Text<N> &sql) : _sql(sql) {
+		}
+
+		/*!
+		 * \brief Add the FROM clause to a SELECT.
+		 */
+		template <size_t M>
+		constexpr auto from(const char (&table)[M]) const {
+				static_assert(Last == Clause::Select, "FROM goes right after SELECT");
+				return makeQuery<Clause::From>(_sql + text(" FROM ") + text(table));
+		}
+
+		/*!
+		 * \brief Add the WHERE clause to a SELECT, UPDATE or DELETE.
+		 *
+		 * @param condition Condition of the clause, with "?" placeholders for the values.
+		 */
+		template <size_t M>
+		constexpr auto where(const char (&condition)[M]) const {
+				static_assert(Last == Clause::From || Last == Clause::Set || Last == Clause::Delete, \
+				              "WHERE goes after FROM, SET or DELETE FROM, and only once");
+				/* Only a SELECT can have more clauses after WHERE */
+				return makeQuery<(Last == Clause::From) ? Clause::Where : Clause::Complete>( \
+				       _sql + text(" WHERE ") + text(condition));
+		}
+
+		/*!
+		 * \brief Add the GROUP BY clause to a SELECT.
+		 */
+		template <size_t... M>
+		constexpr auto groupBy(const char (&...columns)[M]) const {
+				static_assert(Last == Clause::From || Last == Clause::Where, \
+				              "GROUP BY goes after FROM or WHERE");
+				return makeQuery<Clause::GroupBy>(_sql + text(" GROUP BY ") + list(text(columns)...));
+		}
+
+		/*!
+		 * \brief Add the HAVING clause to a SELECT.
+		 */
+		template <size_t M>
+		constexpr auto having(const char (&condition)[M]) const {
+				static_assert(Last == Clause::GroupBy, "HAVING goes right after GROUP BY");
+				return makeQuery<Clause::Having>(_sql + text(" HAVING ") + text(condition));
+		}
+
+		/*!
+		 * \brief Add the ORDER BY clause to a SELECT.
+		 *
+		 * @param columns Columns sorting the rows, which may end in " DESC".
+		 */
+		template <size_t... M>
+		constexpr auto orderBy(const char (&...columns)[M]) const {
+				static_assert(Last >= Clause::From && Last <= Clause::Having, \
+				              "ORDER BY goes after FROM, WHERE, GROUP BY or HAVING");
+				return makeQuery<Clause::OrderBy>(_sql + text(" ORDER BY ") + list(text(columns)...));
+		}
+
+		/*!
+		 * \brief Add the LIMIT clause to a SELECT, with the count bound to a "?" placeholder.
+		 */
+		constexpr auto limit() const {
+				static_assert(Last >= Clause::From && Last <= Clause::OrderBy, \
+				              "LIMIT goes after the other clauses of a SELECT");
+				return makeQuery<Clause::Limit>(_sql + text(" LIMIT ?"));
+		}
+
+		/*!
+		 * \brief Add the LIMIT clause to a SELECT, with a count known at compile time.
+		 */
+		template <unsigned long long Count>
+		constexpr auto limit() const {
+				static_assert(Last >= Clause::From && Last <= Clause::OrderBy, \
+				              "LIMIT goes after the other clauses of a SELECT");
+				return makeQuery<Clause::Limit>(_sql + text(" LIMIT ") + Number<Count>::text());
+		}
+
+		/*!
+		 * \brief Add the OFFSET of the LIMIT clause, bound to a "?" placeholder.
+		 */
+		constexpr auto offset() const {
+				static_assert(Last == Clause::Limit, "OFFSET goes right after LIMIT");
+				return makeQuery<Clause::Offset>(_sql + text(" OFFSET ?"));
+		}
+
+		/*!
+		 * \brief Add the OFFSET of the LIMIT clause, with a value known at compile time.
+		 */
+		template <unsigned long long Count>
+		constexpr auto offset() const {
+				static_assert(Last == Clause::Limit, "OFFSET goes right after LIMIT");
+				return makeQuery<Clause::Offset>(_sql + text(" OFFSET ") + Number<Count>::text());
+		}
+
+		/*!
+		 * \brief Add the SET clause to an UPDATE, with a "?" placeholder for each column.
+		 */
+		template <size_t... M>
+		constexpr auto set(const char (&...columns)[M]) const {
+				static_assert(Last == Clause::Update, "SET goes right after UPDATE");
+				static_assert(sizeof...(M) > 0, "SET needs at least one column");
+				return makeQuery<Clause::Set>(_sql + text(" SET ") + list((text(columns) + text(" = ?"))...));
+		}
+
+		/*!
+		 * \brief Null terminated sql text of the query.
+		 */
+		constexpr const char* c_str() const {
+				static_assert(Last != Clause::Update, "An UPDATE needs its SET clause");
+				return _sql.c_str();
+		}
+
+		constexpr std::string_view view() const {
+				return _sql.view();
+		}
+
+		static constexpr size_t size() {
+				return N;
+		}
+
+		/*!
+		 * \brief Let the query be given to the methods taking sql as const char*.
+		 */
+		constexpr operator const char*() const {
+				static_assert(Last != Clause::Update, "An UPDATE needs its SET clause");
+				return _sql.c_str();
+		}
+
+private:
+		template <Clause Next, size_t M>
+		static constexpr StaticQuery<M, Next> makeQuery(const Text<M> &sql){
+				return StaticQuery<M, Next>(sql);
+		}
+
+		Text<N> _sql;/*!< Sql text composed so far.*/
+};
+
+/*!
+ * \brief Start a SELECT query.
+ *
+ * @param columns Columns selected, or "*".
+ */
+template <size_t... M>
+constexpr auto select(const char (&...columns)[M]){
+		static_assert(sizeof...(M) > 0, "SELECT needs at least one column");
+		auto sql = text("SELECT ") + list(text(columns)...);
+
+		return StaticQuery<decltype(sql)::size(), Clause::Select>(sql);
+}
+
+/*!
+ * \brief Compose an INSERT query with a "?" placeholder for each column.
+ *
+ * @param table   Table where the record is inserted.
+ * @param columns Columns given a value.
+ */
+template <size_t T, size_t... M>
+constexpr auto insertInto(const char (&table)[T], const char (&...columns)[M]){
+		static_assert(sizeof...(M) > 0, "INSERT needs at least one column");
+		auto sql = text("INSERT INTO ") + text(table) + text(" (") + list(text(columns)...) + \
+		           text(") VALUES (") + placeholders<sizeof...(M)>() + text(")");
+
+		return StaticQuery<decltype(sql)::size(), Clause::Complete>(sql);
+}
+
+/*!
+ * \brief Start an UPDATE query, which has to be followed by set().
+ */
+template <size_t T>
+constexpr auto update(const char (&table)[T]){
+		auto sql = text("UPDATE ") + text(table);
+
+		return StaticQuery<decltype(sql)::size(), Clause::Update>(sql);
+}
+
+/*!
+ * \brief Start a DELETE query. Without where() every record of the table is deleted.
+ */
+template <size_t T>
+constexpr auto deleteFrom(const char (&table)[T]){
+		auto sql = text("DELETE FROM ") + text(table);
+
+		return StaticQuery<decltype(sql)::size(), Clause::Delete>(sql);
+}
+
+} // namespace fixed
+
+} // namespace query
+
+#endif // SQLITE3STATICQUERY_H
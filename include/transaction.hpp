@@ -0,0 +1,160 @@
+/*
+ * This file is part of Sqlite3Utils.
+ *
+ * Sqlite3Utils is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Sqlite3Utils is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Sqlite3Utils.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef SQLITE3TRANSACTION_H
+#define SQLITE3TRANSACTION_H
+
+#include <string>
+#include "handler.hpp"
+
+namespace handler {
+
+/*!
+ * \brief Locking behaviour of a transaction when it begins.
+ */
+enum class TransactionMode {
+		Deferred,/*!< Locks are taken when the database is first read or written.*/
+		Immediate,/*!< The write lock is taken when the transaction begins.*/
+		Exclusive/*!< The write lock is taken and readers are blocked (rollback journal only).*/
+};
+
+/*! \brief Scoped transaction on a Sqlite3Db.
+ *
+ * The transaction begins when the object is created. It is committed when commit() is called
+ * or when the object goes out of scope normally, and rolled back when rollback() is called
+ * or when the scope is left because of an exception. The BEGIN, COMMIT and ROLLBACK
+ * statements are compiled when the handler connects, so opening and closing a transaction
+ * does not compile any sql.
+ *
+ * \include transaction.cpp
+ */
+class Transaction {
+public:
+		/*!
+		 * \brief Begin a transaction on the handler given.
+		 *
+		 * @param db   Handler where the transaction takes place.
+		 * @param mode Locking mode of the transaction. Default value is Deferred.
+		 */
+		explicit Transaction(Sqlite3Db &db, TransactionMode mode = TransactionMode::Deferred);
+
+		/*!
+		 * \brief Commit the transaction if it is still active, or roll it back when the scope is
+		 *  being left because of an exception (or the commit fails).
+		 */
+		~Transaction();
+
+		Transaction(const Transaction&) = delete;
+		Transaction& operator=(const Transaction&) = delete;
+
+		/*!
+		 * \brief Commit the changes done during the transaction.
+		 *
+		 * @return EXIT_SUCCESS if the changes were committed. EXIT_FAILURE otherwise, in which case
+		 *  the transaction is still active.
+		 */
+		bool commit();
+
+		/*!
+		 * \brief Discard the changes done during the transaction.
+		 *
+		 * @return EXIT_SUCCESS if the changes were discarded. EXIT_FAILURE otherwise.
+		 */
+		bool rollback();
+
+		/*!
+		 * \brief Check if the transaction began and was not committed or rolled back yet.
+		 *
+		 * @return True if the transaction is active. False otherwise.
+		 */
+		bool isActive() const {
+				return _active;
+		};
+
+private:
+		Sqlite3Db &_db;/*!< Handler where the transaction takes place.*/
+		bool _active;/*!< Whether the transaction is still open.*/
+		int _exceptions;/*!< Uncaught exceptions when the transaction began.*/
+};
+
+/*! \brief Scoped savepoint on a Sqlite3Db.
+ *
+ * Savepoints can be nested, inside or outside of a Transaction. The savepoint is released
+ * (its changes kept) when release() is called or the object goes out of scope normally,
+ * and its changes are discarded when rollback() is called or the scope is left because of
+ * an exception. When no name is given, a fixed name is used, whose statements are compiled
+ * in advance.
+ *
+ * \include transaction.cpp
+ */
+class Savepoint {
+public:
+		/*!
+		 * \brief Open a savepoint on the handler given.
+		 *
+		 * @param db   Handler where the savepoint is opened.
+		 * @param name Name of the savepoint. Nested savepoints may share the same name.
+		 */
+		explicit Savepoint(Sqlite3Db &db, const std::string &name = default_name);
+
+		/*!
+		 * \brief Release the savepoint if it is still active, or roll it back when the scope is
+		 *  being left because of an exception (or the release fails).
+		 */
+		~Savepoint();
+
+		Savepoint(const Savepoint&) = delete;
+		Savepoint& operator=(const Savepoint&) = delete;
+
+		/*!
+		 * \brief Keep the changes done since the savepoint was opened.
+		 *
+		 * @return EXIT_SUCCESS if the savepoint was released. EXIT_FAILURE otherwise.
+		 */
+		bool release();
+
+		/*!
+		 * \brief Discard the changes done since the savepoint was opened, and close it.
+		 *
+		 * @return EXIT_SUCCESS if the changes were discarded. EXIT_FAILURE otherwise.
+		 */
+		bool rollback();
+
+		/*!
+		 * \brief Check if the savepoint was opened and not released or rolled back yet.
+		 *
+		 * @return True if the savepoint is active. False otherwise.
+		 */
+		bool isActive() const {
+				return _active;
+		};
+
+		static constexpr const char *default_name = "sqlite3utils_savepoint";/*!< Name used when none is given.*/
+
+private:
+		bool execute(int statement, const std::string &command);
+
+		Sqlite3Db &_db;/*!< Handler where the savepoint is opened.*/
+		std::string _name;/*!< Name of the savepoint.*/
+		bool _active;/*!< Whether the savepoint is still open.*/
+		int _exceptions;/*!< Uncaught exceptions when the savepoint was opened.*/
+};
+
+} // namespace handler
+
+#endif // SQLITE3TRANSACTION_H
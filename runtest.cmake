@@ -7,6 +7,10 @@ execute_process(COMMAND ./unit_tests
 file(REMOVE ${CMAKE_BINARY_DIR}/tests/MyDB.db)
 file(REMOVE ${CMAKE_BINARY_DIR}/tests/CreatedDB.db)
 file(REMOVE ${CMAKE_BINARY_DIR}/tests/NoExtensionDB)
+file(REMOVE ${CMAKE_BINARY_DIR}/tests/GroupCommitDB.db ${CMAKE_BINARY_DIR}/tests/GroupCommitDB.db-wal ${CMAKE_BINARY_DIR}/tests/GroupCommitDB.db-shm)
+file(REMOVE ${CMAKE_BINARY_DIR}/tests/MmapDB.db)
+file(REMOVE ${CMAKE_BINARY_DIR}/tests/OptionsDB.db ${CMAKE_BINARY_DIR}/tests/OptionsDB.db-wal ${CMAKE_BINARY_DIR}/tests/OptionsDB.db-shm)
+file(REMOVE ${CMAKE_BINARY_DIR}/tests/PoolDB.db ${CMAKE_BINARY_DIR}/tests/PoolDB.db-wal ${CMAKE_BINARY_DIR}/tests/PoolDB.db-shm)
 
 if(status)
   MESSAGE(STATUS "${CMAKE_BINARY_DIR}")
@@ -0,0 +1,147 @@
+/*
+ * This file is part of Sqlite3Utils.
+ *
+ * Sqlite3Utils is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Sqlite3Utils is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Sqlite3Utils.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <algorithm>
+#include "../include/async.hpp"
+
+using handler::AsyncSqlite3Db;
+using handler::QueryResult;
+using handler::Sqlite3Db;
+
+/******************************CONSTRUCTOR*************************************/
+
+handler::AsyncSqlite3Db::AsyncSqlite3Db(std::string db_path, size_t queue_depth, \
+                                        const OpenOptions &options) :
+		_db(new Sqlite3Db(db_path, options)), _queue_depth(std::max<size_t>(queue_depth, 1)) {
+		/* A handler that could not be opened stays disconnected, so its jobs just fail */
+		if (!_db->isConnected())
+				SQLITE3UTILS_LOG_ERROR("Can't open the handler of the worker for %s", db_path.c_str());
+
+		/* The worker starts once every member it uses is built */
+		_worker = std::thread(&AsyncSqlite3Db::work, this);
+}
+
+/******************************DESTRUCTOR**************************************/
+
+handler::AsyncSqlite3Db::~AsyncSqlite3Db(){
+		{
+				std::lock_guard<std::mutex> lock(_mutex);
+				_stop = true;
+		}
+		_queued.notify_one();
+		_worker.join();
+}
+
+/******************************executeQuery************************************/
+std::future<QueryResult> handler::AsyncSqlite3Db::executeQuery(std::string sql_query, \
+                                                               std::vector<int> indexes_stmt){
+		return submit([sql_query = std::move(sql_query), indexes_stmt = std::move(indexes_stmt)](Sqlite3Db &db) {
+				QueryResult result;
+				result.status = db.executeQuery(sql_query.c_str(), result.data, indexes_stmt);
+				return result;
+		});
+}
+
+/******************************executeQuery (bind)*****************************/
+std::future<QueryResult> handler::AsyncSqlite3Db::executeQuery(std::string sql_query, \
+                                                               std::vector<std::string> bind_values, \
+                                                               std::vector<int> indexes_stmt){
+		return submit([sql_query = std::move(sql_query), bind_values = std::move(bind_values), \
+		               indexes_stmt = std::move(indexes_stmt)](Sqlite3Db &db) {
+				QueryResult result;
+				result.status = db.executeQuery(sql_query.c_str(), bind_values, result.data, indexes_stmt);
+				return result;
+		});
+}
+
+/******************************selectRecords***********************************/
+std::future<std::vector<std::string> > handler::AsyncSqlite3Db::selectRecords(select_query_param select_options){
+		return submit([select_options = std::move(select_options)](Sqlite3Db &db) {
+				return db.selectRecords(select_options);
+		});
+}
+
+/******************************insertRecord************************************/
+std::future<bool> handler::AsyncSqlite3Db::insertRecord(std::string table_name, std::vector<std::string> values){
+		return submit([table_name = std::move(table_name), values = std::move(values)](Sqlite3Db &db) {
+				return db.insertRecord(table_name, values);
+		});
+}
+
+/******************************updateTable*************************************/
+std::future<bool> handler::AsyncSqlite3Db::updateTable(std::string table_name, \
+                                                       std::vector<FieldDescription> set_fields, \
+                                                       std::string where_cond){
+		return submit([table_name = std::move(table_name), set_fields = std::move(set_fields), \
+		               where_cond = std::move(where_cond)](Sqlite3Db &db) {
+				return db.updateTable(table_name, set_fields, where_cond);
+		});
+}
+
+/******************************enqueue*****************************************/
+bool handler::AsyncSqlite3Db::enqueue(std::unique_ptr<Job> job, bool wait){
+		{
+				std::unique_lock<std::mutex> lock(_mutex);
+
+				if (_queue.size() >= _queue_depth) {
+						if (!wait)
+								return false;
+						_taken.wait(lock, [this] {
+								return _queue.size() < _queue_depth;
+						});
+				}
+				_queue.push_back(std::move(job));
+		}
+		_queued.notify_one();
+		return true;
+}
+
+/******************************work********************************************/
+void handler::AsyncSqlite3Db::work(){
+		std::unique_ptr<Job> job;
+
+		for (;;) {
+				{
+						std::unique_lock<std::mutex> lock(_mutex);
+
+						_queued.wait(lock, [this] {
+								return _stop || !_queue.empty();
+						});
+						/* Jobs queued before the destruction are still run */
+						if (_queue.empty())
+								return;
+						job = std::move(_queue.front());
+						_queue.pop_front();
+				}
+				_taken.notify_one();
+
+				job->run(*_db);
+				job.reset();
+		}
+}
+
+/*************************getters and setters******************************/
+
+bool handler::AsyncSqlite3Db::isConnected() const {
+		return _db->isConnected();
+}
+
+size_t handler::AsyncSqlite3Db::pending() const {
+		std::lock_guard<std::mutex> lock(_mutex);
+		return _queue.size();
+}
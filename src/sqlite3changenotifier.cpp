@@ -0,0 +1,198 @@
+/*
+ * This file is part of Sqlite3Utils.
+ *
+ * Sqlite3Utils is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Sqlite3Utils is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Sqlite3Utils.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <cstdlib>
+#include "../include/change_notifier.hpp"
+
+using handler::TableChange;
+
+/******************************attach******************************************/
+void handler::ChangeNotifier::attach(sqlite3 *db){
+		{
+				std::lock_guard<std::mutex> lock(_mutex);
+				/* A new connection has its own data version, and nothing pending */
+				_pending.clear();
+				_committed.clear();
+				_has_committed.store(false, std::memory_order_relaxed);
+				_data_version = -1;
+		}
+		sqlite3_update_hook(db, update, this);
+		sqlite3_commit_hook(db, commit, this);
+		sqlite3_rollback_hook(db, rollback, this);
+}
+
+/******************************detach******************************************/
+void handler::ChangeNotifier::detach(sqlite3 *db){
+		if (db == NULL)
+				return;
+		sqlite3_update_hook(db, NULL, NULL);
+		sqlite3_commit_hook(db, NULL, NULL);
+		sqlite3_rollback_hook(db, NULL, NULL);
+}
+
+/******************************subscribe***************************************/
+size_t handler::ChangeNotifier::subscribe(const std::string &table, TableChangeCallback callback){
+		std::lock_guard<std::mutex> lock(_mutex);
+
+		_subscriptions.push_back({_next_id, table, std::move(callback)});
+		return _next_id++;
+}
+
+/******************************unsubscribe*************************************/
+bool handler::ChangeNotifier::unsubscribe(size_t id){
+		std::lock_guard<std::mutex> lock(_mutex);
+
+		for (auto it = _subscriptions.begin(); it != _subscriptions.end(); ++it) {
+				if (it->id == id) {
+						_subscriptions.erase(it);
+						return EXIT_SUCCESS;
+				}
+		}
+		return EXIT_FAILURE;
+}
+
+/******************************dispatch****************************************/
+void handler::ChangeNotifier::dispatch(sqlite3 *db){
+		/* Every statement done ends up here, so the common case costs one load */
+		if (!_has_committed.load(std::memory_order_acquire) || sqlite3_get_autocommit(db) == 0)
+				return;
+
+		std::vector<TableChange> changes;
+		{
+				std::lock_guard<std::mutex> lock(_mutex);
+				changes.swap(_committed);
+				_has_committed.store(false, std::memory_order_relaxed);
+		}
+		deliver(changes);
+}
+
+/******************************updateDataVersion*******************************/
+bool handler::ChangeNotifier::updateDataVersion(int64_t version){
+		std::lock_guard<std::mutex> lock(_mutex);
+		bool changed = (version != _data_version);
+
+		_data_version = version;
+		return changed;
+}
+
+/******************************notifyExternal**********************************/
+void handler::ChangeNotifier::notifyExternal(){
+		std::vector<std::pair<TableChange, TableChangeCallback> > calls;
+
+		/* Which tables changed is not known, so each listener is told its table changed */
+		{
+				std::lock_guard<std::mutex> lock(_mutex);
+				for (const Subscription &subscription : _subscriptions) {
+						TableChange change;
+
+						change.table = subscription.table;
+						change.external = true;
+						calls.emplace_back(std::move(change), subscription.callback);
+				}
+		}
+
+		for (auto &call : calls)
+				call.second(call.first);
+}
+
+/******************************isWatched***************************************/
+bool handler::ChangeNotifier::isWatched(const std::string &table) const {
+		for (const Subscription &subscription : _subscriptions) {
+				if (subscription.table.empty() || subscription.table == table)
+						return true;
+		}
+		return false;
+}
+
+/******************************update******************************************/
+void handler::ChangeNotifier::update(void *context, int operation, const char *database, \
+                                     const char *table, sqlite3_int64 rowid){
+		ChangeNotifier *notifier = static_cast<ChangeNotifier*>(context);
+		std::lock_guard<std::mutex> lock(notifier->_mutex);
+		(void)database;
+
+		/* The hook runs for every row written, so tables nobody listens to cost one search */
+		auto pending = notifier->_pending.find(table);
+		if (pending == notifier->_pending.end()) {
+				if (!notifier->isWatched(table))
+						return;
+				pending = notifier->_pending.emplace(table, TableChange()).first;
+				pending->second.table = table;
+		}
+
+		switch (operation) {
+		case SQLITE_INSERT:
+				pending->second.inserted.push_back(rowid);
+				break;
+		case SQLITE_UPDATE:
+				pending->second.updated.push_back(rowid);
+				break;
+		case SQLITE_DELETE:
+				pending->second.deleted.push_back(rowid);
+				break;
+		}
+}
+
+/******************************commit******************************************/
+int handler::ChangeNotifier::commit(void *context){
+		ChangeNotifier *notifier = static_cast<ChangeNotifier*>(context);
+		std::lock_guard<std::mutex> lock(notifier->_mutex);
+
+		/* The commit is not done yet, the changes wait for dispatch() */
+		for (auto &pending : notifier->_pending)
+				notifier->_committed.push_back(std::move(pending.second));
+		notifier->_pending.clear();
+		if (!notifier->_committed.empty())
+				notifier->_has_committed.store(true, std::memory_order_release);
+
+		/* Returning zero lets the commit go on */
+		return 0;
+}
+
+/******************************rollback****************************************/
+void handler::ChangeNotifier::rollback(void *context){
+		ChangeNotifier *notifier = static_cast<ChangeNotifier*>(context);
+		std::lock_guard<std::mutex> lock(notifier->_mutex);
+
+		/* Includes the changes of a commit that failed after its hook ran */
+		notifier->_pending.clear();
+		notifier->_committed.clear();
+		notifier->_has_committed.store(false, std::memory_order_relaxed);
+}
+
+/******************************deliver*****************************************/
+void handler::ChangeNotifier::deliver(const std::vector<TableChange> &changes){
+		if (changes.empty())
+				return;
+
+		std::vector<std::pair<const TableChange*, TableChangeCallback> > calls;
+
+		/* The listeners are copied, so they can add or remove listeners when called */
+		{
+				std::lock_guard<std::mutex> lock(_mutex);
+				for (const TableChange &change : changes) {
+						for (const Subscription &subscription : _subscriptions) {
+								if (subscription.table.empty() || subscription.table == change.table)
+										calls.emplace_back(&change, subscription.callback);
+						}
+				}
+		}
+
+		for (auto &call : calls)
+				call.second(*call.first);
+}
@@ -0,0 +1,96 @@
+/*
+ * This file is part of Sqlite3Utils.
+ *
+ * Sqlite3Utils is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Sqlite3Utils is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Sqlite3Utils.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "../include/column_descriptor.hpp"
+
+using handler::Affinity;
+
+static inline char upper(char c){
+		return (c >= 'a' && c <= 'z') ? static_cast<char>(c - 'a' + 'A') : c;
+}
+
+/* Check if the token, in upper case, is inside of the text in any case */
+static bool containsToken(std::string_view text, std::string_view token){
+		if (token.size() > text.size())
+				return false;
+
+		for (size_t i = 0; i + token.size() <= text.size(); ++i) {
+				size_t j = 0;
+
+				while (j < token.size() && upper(text[i + j]) == token[j])
+						++j;
+				if (j == token.size())
+						return true;
+		}
+		return false;
+}
+
+/******************************operator==**************************************/
+bool handler::operator==(const ColumnDescriptor &a, const ColumnDescriptor &b){
+		return a.name == b.name && a.declared_type == b.declared_type && \
+		       a.affinity == b.affinity && a.not_null == b.not_null && \
+		       a.primary_key == b.primary_key && a.default_value == b.default_value;
+}
+
+bool handler::operator!=(const ColumnDescriptor &a, const ColumnDescriptor &b){
+		return !(a == b);
+}
+
+/******************************affinityOf**************************************/
+Affinity handler::affinityOf(std::string_view declared_type){
+		/* Same order as getAffinity(), text and real tokens are checked in turns */
+		static const std::string_view text_tokens[] = {"CHAR", "CLOB", "TEXT"};
+		static const std::string_view real_tokens[] = {"REAL", "FLOA", "DOUB"};
+
+		if (containsToken(declared_type, "NULL"))
+				return Affinity::Null;
+		if (containsToken(declared_type, "INT"))
+				return Affinity::Integer;
+		if (declared_type.empty() || containsToken(declared_type, "BLOB"))
+				return Affinity::Blob;
+
+		for (size_t i = 0; i < 3; ++i) {
+				if (containsToken(declared_type, text_tokens[i]))
+						return Affinity::Text;
+				if (containsToken(declared_type, real_tokens[i]))
+						return Affinity::Real;
+		}
+		return Affinity::Numeric;
+}
+
+/******************************affinityFromName********************************/
+Affinity handler::affinityFromName(std::string_view name){
+		if (name == "INTEGER")
+				return Affinity::Integer;
+		if (name == "REAL")
+				return Affinity::Real;
+		if (name == "NUMERIC")
+				return Affinity::Numeric;
+		if (name == "BLOB")
+				return Affinity::Blob;
+		if (name == "NULL")
+				return Affinity::Null;
+		return Affinity::Text;
+}
+
+/******************************affinityName************************************/
+const std::string &handler::affinityName(Affinity affinity){
+		static const std::string names[] = {"INTEGER", "REAL", "NUMERIC", "TEXT", "BLOB", "NULL"};
+
+		return names[static_cast<int>(affinity)];
+}
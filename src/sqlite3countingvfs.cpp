@@ -0,0 +1,322 @@
+/*
+ * This file is part of Sqlite3Utils.
+ *
+ * Sqlite3Utils is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Sqlite3Utils is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Sqlite3Utils.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <atomic>
+#include <mutex>
+#include <new>
+#include "../include/counting_vfs.hpp"
+
+namespace {
+
+/* File of the counting VFS, the file of the default VFS is stored right after it */
+struct CountingFile {
+		sqlite3_file base;
+		sqlite3_file *real;
+		std::atomic<uint64_t> reads{0};
+		std::atomic<uint64_t> read_bytes{0};
+		std::atomic<uint64_t> fetches{0};
+		std::atomic<uint64_t> fetch_hits{0};
+};
+
+sqlite3_vfs counting_vfs;
+sqlite3_io_methods counting_methods[3];
+const char *counting_vfs_name = "sqlite3utils_counting";
+
+sqlite3_vfs *realVfs(sqlite3_vfs *vfs){
+		return static_cast<sqlite3_vfs*>(vfs->pAppData);
+}
+
+sqlite3_file *realFile(sqlite3_file *file){
+		return reinterpret_cast<CountingFile*>(file)->real;
+}
+
+/******************************io methods**************************************/
+int countingClose(sqlite3_file *file){
+		CountingFile *counting = reinterpret_cast<CountingFile*>(file);
+		int rc = counting->real->pMethods->xClose(counting->real);
+
+		/* The memory is freed by sqlite3, only the counters built by countingOpen() end here */
+		counting->~CountingFile();
+		return rc;
+}
+
+int countingRead(sqlite3_file *file, void *buffer, int amount, sqlite3_int64 offset){
+		CountingFile *counting = reinterpret_cast<CountingFile*>(file);
+
+		counting->reads.fetch_add(1, std::memory_order_relaxed);
+		counting->read_bytes.fetch_add(amount, std::memory_order_relaxed);
+		return counting->real->pMethods->xRead(counting->real, buffer, amount, offset);
+}
+
+int countingWrite(sqlite3_file *file, const void *buffer, int amount, sqlite3_int64 offset){
+		return realFile(file)->pMethods->xWrite(realFile(file), buffer, amount, offset);
+}
+
+int countingTruncate(sqlite3_file *file, sqlite3_int64 size){
+		return realFile(file)->pMethods->xTruncate(realFile(file), size);
+}
+
+int countingSync(sqlite3_file *file, int flags){
+		return realFile(file)->pMethods->xSync(realFile(file), flags);
+}
+
+int countingFileSize(sqlite3_file *file, sqlite3_int64 *size){
+		return realFile(file)->pMethods->xFileSize(realFile(file), size);
+}
+
+int countingLock(sqlite3_file *file, int lock){
+		return realFile(file)->pMethods->xLock(realFile(file), lock);
+}
+
+int countingUnlock(sqlite3_file *file, int lock){
+		return realFile(file)->pMethods->xUnlock(realFile(file), lock);
+}
+
+int countingCheckReservedLock(sqlite3_file *file, int *result){
+		return realFile(file)->pMethods->xCheckReservedLock(realFile(file), result);
+}
+
+int countingFileControl(sqlite3_file *file, int op, void *arg){
+		return realFile(file)->pMethods->xFileControl(realFile(file), op, arg);
+}
+
+int countingSectorSize(sqlite3_file *file){
+		return realFile(file)->pMethods->xSectorSize(realFile(file));
+}
+
+int countingDeviceCharacteristics(sqlite3_file *file){
+		return realFile(file)->pMethods->xDeviceCharacteristics(realFile(file));
+}
+
+int countingShmMap(sqlite3_file *file, int page, int page_size, int extend, void volatile **pp){
+		return realFile(file)->pMethods->xShmMap(realFile(file), page, page_size, extend, pp);
+}
+
+int countingShmLock(sqlite3_file *file, int offset, int n, int flags){
+		return realFile(file)->pMethods->xShmLock(realFile(file), offset, n, flags);
+}
+
+void countingShmBarrier(sqlite3_file *file){
+		realFile(file)->pMethods->xShmBarrier(realFile(file));
+}
+
+int countingShmUnmap(sqlite3_file *file, int delete_flag){
+		return realFile(file)->pMethods->xShmUnmap(realFile(file), delete_flag);
+}
+
+int countingFetch(sqlite3_file *file, sqlite3_int64 offset, int amount, void **pp){
+		CountingFile *counting = reinterpret_cast<CountingFile*>(file);
+		int rc = counting->real->pMethods->xFetch(counting->real, offset, amount, pp);
+
+		/* A NULL page means sqlite3 falls back to xRead for it */
+		counting->fetches.fetch_add(1, std::memory_order_relaxed);
+		if (rc == SQLITE_OK && *pp != NULL)
+				counting->fetch_hits.fetch_add(1, std::memory_order_relaxed);
+		return rc;
+}
+
+int countingUnfetch(sqlite3_file *file, sqlite3_int64 offset, void *page){
+		return realFile(file)->pMethods->xUnfetch(realFile(file), offset, page);
+}
+
+/******************************vfs methods*************************************/
+int countingOpen(sqlite3_vfs *vfs, const char *name, sqlite3_file *file, int flags, int *out_flags){
+		/* sqlite3 only hands raw memory of szOsFile bytes, the counters are built in it */
+		CountingFile *counting = new (file) CountingFile();
+		int rc;
+
+		counting->real = reinterpret_cast<sqlite3_file*>(counting + 1);
+
+		rc = realVfs(vfs)->xOpen(realVfs(vfs), name, counting->real, flags, out_flags);
+
+		/* Expose the same version of the io methods as the file of the default VFS */
+		if (counting->real->pMethods != NULL) {
+				int version = counting->real->pMethods->iVersion;
+				counting->base.pMethods = &counting_methods[((version < 1) ? 1 : (version > 3) ? 3 : version) - 1];
+		} else {
+				/* Without io methods xClose is never called, so the file ends here */
+				counting->base.pMethods = NULL;
+				counting->~CountingFile();
+		}
+		return rc;
+}
+
+int countingDelete(sqlite3_vfs *vfs, const char *name, int sync_dir){
+		return realVfs(vfs)->xDelete(realVfs(vfs), name, sync_dir);
+}
+
+int countingAccess(sqlite3_vfs *vfs, const char *name, int flags, int *result){
+		return realVfs(vfs)->xAccess(realVfs(vfs), name, flags, result);
+}
+
+int countingFullPathname(sqlite3_vfs *vfs, const char *name, int size, char *out){
+		return realVfs(vfs)->xFullPathname(realVfs(vfs), name, size, out);
+}
+
+void *countingDlOpen(sqlite3_vfs *vfs, const char *name){
+		return realVfs(vfs)->xDlOpen(realVfs(vfs), name);
+}
+
+void countingDlError(sqlite3_vfs *vfs, int size, char *message){
+		realVfs(vfs)->xDlError(realVfs(vfs), size, message);
+}
+
+void (*countingDlSym(sqlite3_vfs *vfs, void *handle, const char *symbol))(void){
+		return realVfs(vfs)->xDlSym(realVfs(vfs), handle, symbol);
+}
+
+void countingDlClose(sqlite3_vfs *vfs, void *handle){
+		realVfs(vfs)->xDlClose(realVfs(vfs), handle);
+}
+
+int countingRandomness(sqlite3_vfs *vfs, int size, char *out){
+		return realVfs(vfs)->xRandomness(realVfs(vfs), size, out);
+}
+
+int countingSleep(sqlite3_vfs *vfs, int microseconds){
+		return realVfs(vfs)->xSleep(realVfs(vfs), microseconds);
+}
+
+int countingCurrentTime(sqlite3_vfs *vfs, double *now){
+		return realVfs(vfs)->xCurrentTime(realVfs(vfs), now);
+}
+
+int countingGetLastError(sqlite3_vfs *vfs, int size, char *message){
+		return realVfs(vfs)->xGetLastError(realVfs(vfs), size, message);
+}
+
+int countingCurrentTimeInt64(sqlite3_vfs *vfs, sqlite3_int64 *now){
+		return realVfs(vfs)->xCurrentTimeInt64(realVfs(vfs), now);
+}
+
+int countingSetSystemCall(sqlite3_vfs *vfs, const char *name, sqlite3_syscall_ptr call){
+		return realVfs(vfs)->xSetSystemCall(realVfs(vfs), name, call);
+}
+
+sqlite3_syscall_ptr countingGetSystemCall(sqlite3_vfs *vfs, const char *name){
+		return realVfs(vfs)->xGetSystemCall(realVfs(vfs), name);
+}
+
+const char *countingNextSystemCall(sqlite3_vfs *vfs, const char *name){
+		return realVfs(vfs)->xNextSystemCall(realVfs(vfs), name);
+}
+
+/* Get the counting file of the main database of a connection, NULL if it is not one */
+CountingFile *mainFile(sqlite3 *db){
+		sqlite3_file *file = NULL;
+
+		if (db == NULL || sqlite3_file_control(db, "main", SQLITE_FCNTL_FILE_POINTER, &file) != SQLITE_OK)
+				return NULL;
+		if (file == NULL || file->pMethods == NULL || \
+		    file->pMethods < counting_methods || file->pMethods >= counting_methods + 3)
+				return NULL;
+		return reinterpret_cast<CountingFile*>(file);
+}
+
+} // namespace
+
+/******************************registerCountingVfs*****************************/
+const char *handler::vfs::registerCountingVfs(){
+		static std::once_flag registered;
+		static bool success = false;
+
+		std::call_once(registered, [] {
+				sqlite3_vfs *real = sqlite3_vfs_find(NULL);
+
+				if (real == NULL)
+						return;
+
+				for (int i = 0; i < 3; ++i) {
+						sqlite3_io_methods &methods = counting_methods[i];
+
+						methods.iVersion = i + 1;
+						methods.xClose = countingClose;
+						methods.xRead = countingRead;
+						methods.xWrite = countingWrite;
+						methods.xTruncate = countingTruncate;
+						methods.xSync = countingSync;
+						methods.xFileSize = countingFileSize;
+						methods.xLock = countingLock;
+						methods.xUnlock = countingUnlock;
+						methods.xCheckReservedLock = countingCheckReservedLock;
+						methods.xFileControl = countingFileControl;
+						methods.xSectorSize = countingSectorSize;
+						methods.xDeviceCharacteristics = countingDeviceCharacteristics;
+						methods.xShmMap = countingShmMap;
+						methods.xShmLock = countingShmLock;
+						methods.xShmBarrier = countingShmBarrier;
+						methods.xShmUnmap = countingShmUnmap;
+						methods.xFetch = countingFetch;
+						methods.xUnfetch = countingUnfetch;
+				}
+
+				/* Only the functions the default VFS has are offered */
+				counting_vfs.iVersion = (real->iVersion > 3) ? 3 : real->iVersion;
+				counting_vfs.szOsFile = static_cast<int>(sizeof(CountingFile)) + real->szOsFile;
+				counting_vfs.mxPathname = real->mxPathname;
+				counting_vfs.zName = counting_vfs_name;
+				counting_vfs.pAppData = real;
+				counting_vfs.xOpen = countingOpen;
+				counting_vfs.xDelete = countingDelete;
+				counting_vfs.xAccess = countingAccess;
+				counting_vfs.xFullPathname = countingFullPathname;
+				counting_vfs.xDlOpen = countingDlOpen;
+				counting_vfs.xDlError = countingDlError;
+				counting_vfs.xDlSym = countingDlSym;
+				counting_vfs.xDlClose = countingDlClose;
+				counting_vfs.xRandomness = countingRandomness;
+				counting_vfs.xSleep = countingSleep;
+				counting_vfs.xCurrentTime = countingCurrentTime;
+				counting_vfs.xGetLastError = countingGetLastError;
+				counting_vfs.xCurrentTimeInt64 = countingCurrentTimeInt64;
+				counting_vfs.xSetSystemCall = countingSetSystemCall;
+				counting_vfs.xGetSystemCall = countingGetSystemCall;
+				counting_vfs.xNextSystemCall = countingNextSystemCall;
+
+				success = (sqlite3_vfs_register(&counting_vfs, 0) == SQLITE_OK);
+		});
+
+		return success ? counting_vfs_name : NULL;
+}
+
+/******************************getIoStats**************************************/
+bool handler::vfs::getIoStats(sqlite3 *db, IoStats &stats){
+		CountingFile *file = mainFile(db);
+
+		if (file == NULL)
+				return false;
+
+		stats.reads = file->reads.load(std::memory_order_relaxed);
+		stats.read_bytes = file->read_bytes.load(std::memory_order_relaxed);
+		stats.fetches = file->fetches.load(std::memory_order_relaxed);
+		stats.fetch_hits = file->fetch_hits.load(std::memory_order_relaxed);
+		return true;
+}
+
+/******************************resetIoStats************************************/
+void handler::vfs::resetIoStats(sqlite3 *db){
+		CountingFile *file = mainFile(db);
+
+		if (file == NULL)
+				return;
+
+		file->reads = 0;
+		file->read_bytes = 0;
+		file->fetches = 0;
+		file->fetch_hits = 0;
+}
@@ -0,0 +1,62 @@
+/*
+ * This file is part of Sqlite3Utils.
+ *
+ * Sqlite3Utils is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Sqlite3Utils is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Sqlite3Utils.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "../include/cursor.hpp"
+#include "../include/handler.hpp"
+#include "../include/logger.hpp"
+
+using handler::Cursor;
+
+/******************************CONSTRUCTOR*************************************/
+
+handler::Cursor::Cursor(CachedStatement &&stmt, Sqlite3Db *handler) :
+		_stmt(std::move(stmt)), _db(handler->_db), _handler(handler), _row(_stmt.get()) {
+}
+
+/******************************next********************************************/
+bool handler::Cursor::next(){
+		_started = true;
+		if (!_stmt)
+				return false;
+
+		if ((_rc = sqlite3_step(_stmt.get())) == SQLITE_ROW)
+				return true;
+
+		if (_rc != SQLITE_DONE)
+				SQLITE3UTILS_LOG_ERROR("SQL error: %s", sqlite3_errmsg(_db));
+		else
+				_handler->dispatchChanges();
+
+		/* No more rows, the statement can be reused by the handler right away */
+		close();
+		return false;
+}
+
+/******************************close*******************************************/
+void handler::Cursor::close(){
+		_stmt.release();
+		_row = RowView();
+}
+
+/******************************begin*******************************************/
+Cursor::iterator handler::Cursor::begin(){
+		if (!_started)
+				return next() ? iterator(this) : iterator();
+
+		return (_rc == SQLITE_ROW && _stmt) ? iterator(this) : iterator();
+}
@@ -0,0 +1,233 @@
+/*
+ * This file is part of Sqlite3Utils.
+ *
+ * Sqlite3Utils is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Sqlite3Utils is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Sqlite3Utils.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <algorithm>
+#include <exception>
+#include "../include/group_commit.hpp"
+#include "../include/transaction.hpp"
+
+using handler::GroupCommitWriter;
+using handler::Sqlite3Db;
+
+/******************************CONSTRUCTOR*************************************/
+
+handler::GroupCommitWriter::GroupCommitWriter(std::string db_path, size_t max_batch, \
+                                              std::chrono::microseconds max_delay, \
+                                              const OpenOptions &options) :
+		_db(new Sqlite3Db(db_path, options)), _max_batch(std::max<size_t>(max_batch, 1)), \
+		_max_delay(max_delay) {
+		/* A handler that could not be opened stays disconnected, so its batches just fail */
+		if (!_db->isConnected())
+				SQLITE3UTILS_LOG_ERROR("Can't open the handler of the writer for %s", db_path.c_str());
+		/* The thread starts once every member it uses is built */
+		_worker = std::thread(&GroupCommitWriter::work, this);
+}
+
+/******************************DESTRUCTOR**************************************/
+
+handler::GroupCommitWriter::~GroupCommitWriter(){
+		{
+				std::lock_guard<std::mutex> lock(_wake_mutex);
+				_stop = true;
+		}
+		_wake.notify_one();
+		_worker.join();
+}
+
+/******************************insertRecord************************************/
+std::future<bool> handler::GroupCommitWriter::insertRecord(std::string table_name, std::vector<std::string> values){
+		return push([table_name = std::move(table_name), values = std::move(values)](Sqlite3Db &db) {
+				return db.insertRecord(table_name, values);
+		});
+}
+
+/******************************updateTable*************************************/
+std::future<bool> handler::GroupCommitWriter::updateTable(std::string table_name, \
+                                                          std::vector<FieldDescription> set_fields, \
+                                                          std::string where_cond){
+		return push([table_name = std::move(table_name), set_fields = std::move(set_fields), \
+		             where_cond = std::move(where_cond)](Sqlite3Db &db) {
+				return db.updateTable(table_name, set_fields, where_cond);
+		});
+}
+
+/******************************deleteRecords***********************************/
+std::future<bool> handler::GroupCommitWriter::deleteRecords(std::string table_name, std::string condition){
+		return push([table_name = std::move(table_name), condition = std::move(condition)](Sqlite3Db &db) {
+				return db.deleteRecords(table_name, condition);
+		});
+}
+
+/******************************submit******************************************/
+std::future<bool> handler::GroupCommitWriter::submit(std::function<bool(Sqlite3Db&)> write){
+		return push(std::move(write));
+}
+
+/******************************push********************************************/
+std::future<bool> handler::GroupCommitWriter::push(std::function<bool(Sqlite3Db&)> write){
+		PendingWrite *pending = new PendingWrite();
+		std::future<bool> done = pending->done.get_future();
+		PendingWrite *head = _head.load(std::memory_order_relaxed);
+
+		pending->write = std::move(write);
+		pending->pushed = std::chrono::steady_clock::now();
+
+		/* Treiber stack push: producers never wait for each other nor for the writer */
+		do {
+				pending->next = head;
+		} while (!_head.compare_exchange_weak(head, pending, std::memory_order_release, \
+		                                      std::memory_order_relaxed));
+
+		/* Only the push to an empty queue can find the writer asleep */
+		if (head == NULL) {
+				std::lock_guard<std::mutex> lock(_wake_mutex);
+				_wake.notify_one();
+		}
+		return done;
+}
+
+/******************************takePending*************************************/
+void handler::GroupCommitWriter::takePending(std::vector<std::unique_ptr<PendingWrite> > &batch){
+		/* The writes left over by a full batch are older than any still on the stack */
+		if (_overflow.size() < _max_batch - batch.size()) {
+				PendingWrite *pending = _head.exchange(NULL, std::memory_order_acquire);
+				size_t first = _overflow.size();
+
+				/* The stack holds the newest write on top, the batch runs them oldest first */
+				for (; pending != NULL; pending = pending->next)
+						_overflow.emplace_back(pending);
+				std::reverse(_overflow.begin() + first, _overflow.end());
+		}
+
+		while (batch.size() < _max_batch && !_overflow.empty()) {
+				batch.push_back(std::move(_overflow.front()));
+				_overflow.pop_front();
+		}
+}
+
+/******************************commitBatch*************************************/
+void handler::GroupCommitWriter::commitBatch(std::vector<std::unique_ptr<PendingWrite> > &batch){
+		std::vector<bool> results(batch.size(), EXIT_FAILURE);
+		std::vector<std::exception_ptr> errors(batch.size());
+		bool committed = false;
+		uint64_t failed = 0;
+
+		{
+				Transaction transaction(*_db, TransactionMode::Immediate);
+
+				if (transaction.isActive()) {
+						for (size_t i = 0; i < batch.size(); ++i) {
+								Savepoint savepoint(*_db);
+
+								if (!savepoint.isActive())
+										continue;
+								try {
+										results[i] = batch[i]->write(*_db);
+								} catch (...) {
+										errors[i] = std::current_exception();
+										results[i] = EXIT_FAILURE;
+								}
+
+								/* A failing write only discards its own changes */
+								if (results[i] == EXIT_SUCCESS)
+										savepoint.release();
+								else
+										savepoint.rollback();
+						}
+						/* If the commit fails the transaction is rolled back when it goes out of scope */
+						committed = (transaction.commit() == EXIT_SUCCESS);
+				}
+		}
+
+		for (size_t i = 0; i < batch.size(); ++i) {
+				if (!committed)
+						results[i] = EXIT_FAILURE;
+				if (results[i] != EXIT_SUCCESS)
+						++failed;
+		}
+
+		/* The counters are updated first, so a caller woken up by its future sees them */
+		_writes.fetch_add(batch.size(), std::memory_order_relaxed);
+		_failed.fetch_add(failed, std::memory_order_relaxed);
+		if (committed) {
+				_batches.fetch_add(1, std::memory_order_relaxed);
+				if (batch.size() > _max_batch_seen.load(std::memory_order_relaxed))
+						_max_batch_seen.store(batch.size(), std::memory_order_relaxed);
+		}
+
+		/* The callers only hear about their writes once the whole batch is durable */
+		for (size_t i = 0; i < batch.size(); ++i) {
+				if (errors[i])
+						batch[i]->done.set_exception(errors[i]);
+				else
+						batch[i]->done.set_value(results[i]);
+		}
+}
+
+/******************************work********************************************/
+void handler::GroupCommitWriter::work(){
+		std::vector<std::unique_ptr<PendingWrite> > batch;
+
+		for (;;) {
+				{
+						std::unique_lock<std::mutex> lock(_wake_mutex);
+						_wake.wait(lock, [this] {
+								return _stop || !_overflow.empty() || _head.load(std::memory_order_acquire) != NULL;
+						});
+				}
+
+				takePending(batch);
+				if (batch.empty()) {
+						if (_stop)
+								return;
+						continue;
+				}
+
+				/* Wait for more writes until the batch is full or its oldest write waited enough */
+				auto deadline = batch.front()->pushed + _max_delay;
+				while (batch.size() < _max_batch && !_stop) {
+						std::unique_lock<std::mutex> lock(_wake_mutex);
+
+						if (!_wake.wait_until(lock, deadline, [this] {
+								return _stop || _head.load(std::memory_order_acquire) != NULL;
+						}))
+								break;
+						lock.unlock();
+						takePending(batch);
+				}
+
+				commitBatch(batch);
+				batch.clear();
+		}
+}
+
+/*************************getters and setters******************************/
+
+bool handler::GroupCommitWriter::isConnected() const {
+		return _db->isConnected();
+}
+
+handler::GroupCommitStats handler::GroupCommitWriter::getStats() const {
+		GroupCommitStats stats;
+
+		stats.writes = _writes.load(std::memory_order_relaxed);
+		stats.failed = _failed.load(std::memory_order_relaxed);
+		stats.batches = _batches.load(std::memory_order_relaxed);
+		stats.max_batch = _max_batch_seen.load(std::memory_order_relaxed);
+		return stats;
+}
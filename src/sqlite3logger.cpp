@@ -0,0 +1,81 @@
+/*
+ * This file is part of Sqlite3Utils.
+ *
+ * Sqlite3Utils is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Sqlite3Utils is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Sqlite3Utils.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <cstdarg>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include "../include/logger.hpp"
+
+std::atomic<int> handler::log::runtime_level(static_cast<int>(handler::LogLevel::Warning));
+
+static std::mutex sink_mutex;
+static std::shared_ptr<handler::LogSink> current_sink = std::make_shared<handler::ConsoleSink>();
+
+/******************************ConsoleSink*************************************/
+void handler::ConsoleSink::write(LogLevel level, const char *message){
+		fprintf((level >= LogLevel::Warning) ? stderr : stdout, "%s\n", message);
+}
+
+/******************************setLevel****************************************/
+void handler::log::setLevel(LogLevel level){
+		runtime_level.store(static_cast<int>(level), std::memory_order_relaxed);
+}
+
+/******************************getLevel****************************************/
+handler::LogLevel handler::log::getLevel(){
+		return static_cast<LogLevel>(runtime_level.load(std::memory_order_relaxed));
+}
+
+/******************************setSink*****************************************/
+void handler::log::setSink(std::shared_ptr<LogSink> sink){
+		std::lock_guard<std::mutex> lock(sink_mutex);
+
+		current_sink = sink ? std::move(sink) : std::make_shared<NullSink>();
+}
+
+/******************************write*******************************************/
+void handler::log::write(LogLevel level, const char *format, ...){
+		std::shared_ptr<LogSink> sink;
+		char buffer[512];
+		std::string long_message;
+		const char *message = buffer;
+		va_list args;
+		int length;
+
+		va_start(args, format);
+		length = vsnprintf(buffer, sizeof(buffer), format, args);
+		va_end(args);
+		if (length < 0)
+				return;
+
+		/* Messages longer than the buffer are formatted again in their full size */
+		if (static_cast<size_t>(length) >= sizeof(buffer)) {
+				long_message.resize(length + 1);
+				va_start(args, format);
+				vsnprintf(&long_message[0], long_message.size(), format, args);
+				va_end(args);
+				message = long_message.c_str();
+		}
+
+		{
+				std::lock_guard<std::mutex> lock(sink_mutex);
+				sink = current_sink;
+		}
+		sink->write(level, message);
+}
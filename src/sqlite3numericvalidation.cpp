@@ -0,0 +1,236 @@
+/*
+ * This file is part of Sqlite3Utils.
+ *
+ * Sqlite3Utils is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Sqlite3Utils is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Sqlite3Utils.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <array>
+#include <atomic>
+#include "../include/numeric_validation.hpp"
+
+/* The vector kernels are built with target attributes, so the rest of the library does not
+ * need -msse2 or -mavx2 and runs on processors without them */
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define SQLITE3UTILS_X86_SIMD 1
+#include <immintrin.h>
+#endif
+
+using handler::SimdLevel;
+
+typedef bool (*CheckFunction)(const char *text, size_t length);
+
+/* Checks of one instruction set */
+struct Kernels {
+		SimdLevel level;
+		CheckFunction digits;
+		CheckFunction real;
+};
+
+/* Classes of each character, a value is valid if all its characters share the class wanted */
+enum : unsigned char { class_digit = 1, class_real = 2 };
+
+static const std::array<unsigned char, 256> char_classes = [] {
+		std::array<unsigned char, 256> classes{};
+
+		for (int c = '0'; c <= '9'; ++c)
+				classes[c] = class_digit | class_real;
+		classes['.'] = class_real;
+		classes[','] = class_real;
+		return classes;
+}();
+
+/******************************scalar kernels**********************************/
+static bool scalarCheck(const char *text, size_t length, unsigned char wanted){
+		unsigned char common = wanted;
+
+		/* No branch per character, the classes are just intersected */
+		for (size_t i = 0; i < length; ++i)
+				common &= char_classes[static_cast<unsigned char>(text[i])];
+		return common != 0;
+}
+
+static bool scalarDigits(const char *text, size_t length){
+		return scalarCheck(text, length, class_digit);
+}
+
+static bool scalarReal(const char *text, size_t length){
+		return scalarCheck(text, length, class_real);
+}
+
+#ifdef SQLITE3UTILS_X86_SIMD
+/******************************SSE2 kernels************************************/
+/* Bytes of v that are digits, or also dots and commas for reals. Bytes over 0x7F are
+ * negative for the signed comparisons, so they are never taken as digits */
+template <bool Real>
+__attribute__((target("sse2"))) static inline __m128i validBytes128(__m128i v){
+		__m128i valid = _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8('0' - 1)), \
+		                              _mm_cmplt_epi8(v, _mm_set1_epi8('9' + 1)));
+
+		if (Real) {
+				valid = _mm_or_si128(valid, _mm_cmpeq_epi8(v, _mm_set1_epi8('.')));
+				valid = _mm_or_si128(valid, _mm_cmpeq_epi8(v, _mm_set1_epi8(',')));
+		}
+		return valid;
+}
+
+template <bool Real>
+__attribute__((target("sse2"))) static bool sse2Check(const char *text, size_t length){
+		if (length < 16)
+				return scalarCheck(text, length, Real ? class_real : class_digit);
+
+		__m128i valid = _mm_set1_epi8(-1);
+		size_t i = 0;
+
+		for (; i + 16 <= length; i += 16)
+				valid = _mm_and_si128(valid, validBytes128<Real>(_mm_loadu_si128(reinterpret_cast<const __m128i*>(text + i))));
+		/* The tail is checked with the last 16 bytes, overlapping the ones already checked */
+		if (i < length)
+				valid = _mm_and_si128(valid, validBytes128<Real>(_mm_loadu_si128(reinterpret_cast<const __m128i*>(text + length - 16))));
+		return _mm_movemask_epi8(valid) == 0xFFFF;
+}
+
+static bool sse2Digits(const char *text, size_t length){
+		return sse2Check<false>(text, length);
+}
+
+static bool sse2Real(const char *text, size_t length){
+		return sse2Check<true>(text, length);
+}
+
+/******************************AVX2 kernels************************************/
+template <bool Real>
+__attribute__((target("avx2"))) static inline __m256i validBytes256(__m256i v){
+		__m256i valid = _mm256_and_si256(_mm256_cmpgt_epi8(v, _mm256_set1_epi8('0' - 1)), \
+		                                 _mm256_cmpgt_epi8(_mm256_set1_epi8('9' + 1), v));
+
+		if (Real) {
+				valid = _mm256_or_si256(valid, _mm256_cmpeq_epi8(v, _mm256_set1_epi8('.')));
+				valid = _mm256_or_si256(valid, _mm256_cmpeq_epi8(v, _mm256_set1_epi8(',')));
+		}
+		return valid;
+}
+
+template <bool Real>
+__attribute__((target("avx2"))) static bool avx2Check(const char *text, size_t length){
+		if (length < 32)
+				return sse2Check<Real>(text, length);
+
+		__m256i valid = _mm256_set1_epi8(-1);
+		size_t i = 0;
+
+		for (; i + 32 <= length; i += 32)
+				valid = _mm256_and_si256(valid, validBytes256<Real>(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(text + i))));
+		if (i < length)
+				valid = _mm256_and_si256(valid, validBytes256<Real>(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(text + length - 32))));
+		return _mm256_movemask_epi8(valid) == -1;
+}
+
+static bool avx2Digits(const char *text, size_t length){
+		return avx2Check<false>(text, length);
+}
+
+static bool avx2Real(const char *text, size_t length){
+		return avx2Check<true>(text, length);
+}
+#endif
+
+/******************************dispatch****************************************/
+static const Kernels scalar_kernels = {SimdLevel::Scalar, scalarDigits, scalarReal};
+#ifdef SQLITE3UTILS_X86_SIMD
+static const Kernels sse2_kernels = {SimdLevel::SSE2, sse2Digits, sse2Real};
+static const Kernels avx2_kernels = {SimdLevel::AVX2, avx2Digits, avx2Real};
+#endif
+
+/* Best instruction set of the processor that is not above the one given */
+static const Kernels *kernelsFor(SimdLevel level){
+#ifdef SQLITE3UTILS_X86_SIMD
+		__builtin_cpu_init();
+		if (level >= SimdLevel::AVX2 && __builtin_cpu_supports("avx2"))
+				return &avx2_kernels;
+		if (level >= SimdLevel::SSE2 && __builtin_cpu_supports("sse2"))
+				return &sse2_kernels;
+#endif
+		(void)level;
+		return &scalar_kernels;
+}
+
+static std::atomic<const Kernels*> active_kernels(NULL);
+
+static const Kernels *kernels(){
+		const Kernels *current = active_kernels.load(std::memory_order_relaxed);
+
+		if (current == NULL) {
+				current = kernelsFor(SimdLevel::AVX2);
+				active_kernels.store(current, std::memory_order_relaxed);
+		}
+		return current;
+}
+
+/******************************getSimdLevel************************************/
+SimdLevel handler::validation::getSimdLevel(){
+		return kernels()->level;
+}
+
+/******************************setSimdLevel************************************/
+SimdLevel handler::validation::setSimdLevel(SimdLevel level){
+		const Kernels *chosen = kernelsFor(level);
+
+		active_kernels.store(chosen, std::memory_order_relaxed);
+		return chosen->level;
+}
+
+/******************************isDigits****************************************/
+bool handler::validation::isDigits(const char *text, size_t length){
+		return length > 0 && kernels()->digits(text, length);
+}
+
+/******************************isRealChars*************************************/
+bool handler::validation::isRealChars(const char *text, size_t length){
+		return length > 0 && kernels()->real(text, length);
+}
+
+/******************************validateColumn**********************************/
+size_t handler::validation::validateColumn(const std::string &affinity, \
+                                           const std::vector<std::string> &values, \
+                                           std::vector<size_t> &invalid){
+		return validateColumn(affinityFromName(affinity), values, invalid);
+}
+
+size_t handler::validation::validateColumn(Affinity affinity, \
+                                           const std::vector<std::string> &values, \
+                                           std::vector<size_t> &invalid){
+		CheckFunction check = NULL;
+
+		invalid.clear();
+
+		/* The affinity is resolved once for the whole column */
+		if (affinity == Affinity::Integer)
+				check = kernels()->digits;
+		else if (affinity == Affinity::Real || affinity == Affinity::Numeric)
+				check = kernels()->real;
+
+		if (check != NULL) {
+				for (size_t i = 0; i < values.size(); ++i) {
+						if (values[i].empty() || !check(values[i].data(), values[i].size()))
+								invalid.push_back(i);
+				}
+		} else if (affinity == Affinity::Null) {
+				for (size_t i = 0; i < values.size(); ++i) {
+						if (values[i] != "NULL")
+								invalid.push_back(i);
+				}
+		}
+		return invalid.size();
+}
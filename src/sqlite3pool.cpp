@@ -0,0 +1,191 @@
+/*
+ * This file is part of Sqlite3Utils.
+ *
+ * Sqlite3Utils is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Sqlite3Utils is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Sqlite3Utils.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <algorithm>
+#include "../include/pool.hpp"
+
+using handler::PooledDb;
+using handler::Sqlite3Db;
+using handler::Sqlite3DbPool;
+
+/******************************PooledDb****************************************/
+
+handler::PooledDb::~PooledDb(){
+		release();
+}
+
+handler::PooledDb::PooledDb(PooledDb &&other) noexcept :
+		_pool(other._pool), _db(other._db) {
+		other._pool = NULL;
+		other._db = NULL;
+}
+
+PooledDb& handler::PooledDb::operator=(PooledDb &&other) noexcept {
+		if (this != &other) {
+				release();
+				_pool = other._pool;
+				_db = other._db;
+				other._pool = NULL;
+				other._db = NULL;
+		}
+		return *this;
+}
+
+void handler::PooledDb::release(){
+		if (_db != NULL) {
+				_pool->giveBack(_db);
+				_pool = NULL;
+				_db = NULL;
+		}
+}
+
+/******************************CONSTRUCTOR*************************************/
+
+handler::Sqlite3DbPool::Sqlite3DbPool(std::string db_path, size_t size, int busy_timeout_ms) : \
+		Sqlite3DbPool(db_path, size, [busy_timeout_ms] {
+				OpenOptions options;
+				options.busy_timeout_ms = busy_timeout_ms;
+				return options;
+		}()) {
+}
+
+handler::Sqlite3DbPool::Sqlite3DbPool(std::string db_path, size_t size, OpenOptions options){
+		/* Readers of WAL databases do not block the writer nor each other */
+		options.journal_mode = JournalMode::Wal;
+
+		size = std::max<size_t>(size, 1);
+		for (size_t i = 0; i < size; ++i) {
+				/* Every handler works with the schema loaded by the first one */
+				if (i == 0)
+						_handlers.emplace_back(new Sqlite3Db(db_path, options));
+				else
+						_handlers.emplace_back(new Sqlite3Db(db_path, options, _handlers.front()->_schema));
+				Sqlite3Db *db = _handlers.back().get();
+
+				_idle.push_back(db);
+				/* The rest would fail the same way. Leases of the handler fail their operations,
+				   and isConnected() reports it */
+				if (!db->isConnected()) {
+						SQLITE3UTILS_LOG_ERROR("Can't open the handlers of the pool for %s", db_path.c_str());
+						break;
+				}
+		}
+		_stats.size = _handlers.size();
+}
+
+/******************************DESTRUCTOR**************************************/
+
+handler::Sqlite3DbPool::~Sqlite3DbPool(){
+		std::lock_guard<std::mutex> lock(_mutex);
+
+		if (_idle.size() != _handlers.size())
+				SQLITE3UTILS_LOG_WARNING("Pool destroyed with %d handlers still leased", \
+				                         static_cast<int>(_handlers.size() - _idle.size()));
+}
+
+/******************************acquire*****************************************/
+PooledDb handler::Sqlite3DbPool::acquire(){
+		std::unique_lock<std::mutex> lock(_mutex);
+		auto start = std::chrono::steady_clock::now();
+		bool waited = _idle.empty();
+
+		_released.wait(lock, [this] {
+				return !_idle.empty();
+		});
+		return take(start, waited);
+}
+
+/******************************acquire (timeout)*******************************/
+PooledDb handler::Sqlite3DbPool::acquire(std::chrono::milliseconds timeout){
+		std::unique_lock<std::mutex> lock(_mutex);
+		auto start = std::chrono::steady_clock::now();
+		bool waited = _idle.empty();
+
+		if (!_released.wait_for(lock, timeout, [this] {
+				return !_idle.empty();
+		})) {
+				++_stats.timeouts;
+				return PooledDb();
+		}
+		return take(start, waited);
+}
+
+/******************************tryAcquire**************************************/
+PooledDb handler::Sqlite3DbPool::tryAcquire(){
+		std::lock_guard<std::mutex> lock(_mutex);
+
+		if (_idle.empty())
+				return PooledDb();
+		return take(std::chrono::steady_clock::time_point(), false);
+}
+
+/******************************take********************************************/
+PooledDb handler::Sqlite3DbPool::take(std::chrono::steady_clock::time_point start, bool waited){
+		Sqlite3Db *db = _idle.back();
+
+		_idle.pop_back();
+		++_stats.acquisitions;
+
+		/* The clock is only read again when the caller actually had to wait */
+		if (waited) {
+				uint64_t wait_ns = std::chrono::duration_cast<std::chrono::nanoseconds>( \
+						std::chrono::steady_clock::now() - start).count();
+
+				++_stats.waits;
+				_stats.total_wait_ns += wait_ns;
+				_stats.max_wait_ns = std::max(_stats.max_wait_ns, wait_ns);
+		}
+		return PooledDb(this, db);
+}
+
+/******************************giveBack****************************************/
+void handler::Sqlite3DbPool::giveBack(Sqlite3Db *db){
+		{
+				std::lock_guard<std::mutex> lock(_mutex);
+				_idle.push_back(db);
+		}
+		_released.notify_one();
+}
+
+/*************************getters and setters******************************/
+
+bool handler::Sqlite3DbPool::isConnected() const {
+		for (auto &db : _handlers) {
+				if (!db->isConnected())
+						return false;
+		}
+		return !_handlers.empty();
+}
+
+handler::PoolStats handler::Sqlite3DbPool::getStats() const {
+		std::lock_guard<std::mutex> lock(_mutex);
+		PoolStats stats = _stats;
+
+		stats.idle = _idle.size();
+		return stats;
+}
+
+void handler::Sqlite3DbPool::resetStats(){
+		std::lock_guard<std::mutex> lock(_mutex);
+
+		_stats.acquisitions = 0;
+		_stats.waits = 0;
+		_stats.timeouts = 0;
+		_stats.total_wait_ns = 0;
+		_stats.max_wait_ns = 0;
+}
@@ -0,0 +1,102 @@
+/*
+ * This file is part of Sqlite3Utils.
+ *
+ * Sqlite3Utils is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Sqlite3Utils is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Sqlite3Utils.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <cstdlib>
+#include "../include/handler.hpp"
+#include "../include/logger.hpp"
+#include "../include/prepared_query.hpp"
+
+/******************************CONSTRUCTOR*************************************/
+
+handler::PreparedQuery::PreparedQuery(CachedStatement &&stmt, Sqlite3Db *handler) :
+		_stmt(std::move(stmt)), _db(handler->_db), _handler(handler), _row(_stmt.get()) {
+}
+
+/******************************bind********************************************/
+bool handler::PreparedQuery::bindInteger(int index, int64_t value){
+		return checkBind(sqlite3_bind_int64(_stmt.get(), index, value), index);
+}
+
+bool handler::PreparedQuery::bind(int index, double value){
+		return checkBind(sqlite3_bind_double(_stmt.get(), index, value), index);
+}
+
+bool handler::PreparedQuery::bind(int index, std::string_view value){
+		return checkBind(sqlite3_bind_text(_stmt.get(), index, value.data(), \
+		                                   static_cast<int>(value.size()), SQLITE_TRANSIENT), index);
+}
+
+bool handler::PreparedQuery::bind(int index, const char *value){
+		if (value == NULL)
+				return bind(index, nullptr);
+		return checkBind(sqlite3_bind_text(_stmt.get(), index, value, -1, SQLITE_TRANSIENT), index);
+}
+
+bool handler::PreparedQuery::bind(int index, BlobView value){
+		/* An empty blob is still a blob, not NULL */
+		if (value.data == NULL)
+				return checkBind(sqlite3_bind_zeroblob(_stmt.get(), index, 0), index);
+		return checkBind(sqlite3_bind_blob(_stmt.get(), index, value.data, \
+		                                   static_cast<int>(value.size), SQLITE_TRANSIENT), index);
+}
+
+bool handler::PreparedQuery::bind(int index, std::nullptr_t){
+		return checkBind(sqlite3_bind_null(_stmt.get(), index), index);
+}
+
+/******************************checkBind***************************************/
+bool handler::PreparedQuery::checkBind(int rc, int index){
+		if (rc == SQLITE_OK)
+				return EXIT_SUCCESS;
+
+		if (!_stmt)
+				SQLITE3UTILS_LOG_ERROR("Query is not prepared, bind operation aborted");
+		else
+				SQLITE3UTILS_LOG_ERROR("SQL error binding parameter %d: %s", index, sqlite3_errstr(rc));
+		return EXIT_FAILURE;
+}
+
+/******************************clearBindings***********************************/
+void handler::PreparedQuery::clearBindings(){
+		if (_stmt)
+				sqlite3_clear_bindings(_stmt.get());
+}
+
+/******************************step********************************************/
+bool handler::PreparedQuery::step(){
+		if (!_stmt) {
+				_rc = SQLITE_MISUSE;
+				return false;
+		}
+
+		if ((_rc = sqlite3_step(_stmt.get())) == SQLITE_ROW)
+				return true;
+
+		if (_rc != SQLITE_DONE)
+				SQLITE3UTILS_LOG_ERROR("SQL error: %s", sqlite3_errmsg(_db));
+		else
+				_handler->dispatchChanges();
+		return false;
+}
+
+/******************************reset*******************************************/
+void handler::PreparedQuery::reset(){
+		if (_stmt)
+				sqlite3_reset(_stmt.get());
+		_rc = SQLITE_OK;
+}
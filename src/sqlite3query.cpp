@@ -27,6 +27,10 @@ const std::string query::data::len(int length){
 		return (" ("+std::to_string(length)+") ");
 }
 
+const std::string query::cl::journal_mode(const std::string mode){
+		return (" journal_mode="+mode+" ");
+}
+
 const std::string query::cl::like(const std::string pattern){
 		const std::string single_quote = "'";
 		return (" LIKE "+single_quote+pattern+single_quote+" ");
@@ -40,6 +44,10 @@ const std::string query::cl::offset(int offset_value){
 		return (" OFFSET "+std::to_string(offset_value)+" ");
 }
 
+const std::string query::cl::setting(const std::string name, const std::string value){
+		return (" "+name+"="+value+" ");
+}
+
 const std::string query::cl::table_info(const std::string table_name){
 		return (" table_info("+table_name+")"+" ");
 }
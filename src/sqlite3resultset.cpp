@@ -0,0 +1,240 @@
+/*
+ * This file is part of Sqlite3Utils.
+ *
+ * Sqlite3Utils is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Sqlite3Utils is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Sqlite3Utils.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "../include/handler.hpp"
+#include "../include/result_set.hpp"
+
+using handler::ColumnType;
+using handler::ResultSet;
+
+/* Check the null bitmap of a column without going through the column index */
+static inline bool isNullBit(const std::vector<uint64_t> &nulls, size_t row){
+		return (nulls[row >> 6] >> (row & 63)) & 1;
+}
+
+/******************************load********************************************/
+int handler::ResultSet::load(sqlite3_stmt *stmt){
+		int rc;
+		int column_count = sqlite3_column_count(stmt);
+
+		clear();
+		_columns.resize(column_count);
+
+		/* Columns coming from a table take their storage from the declared type,
+		   expressions and NUMERIC or BLOB columns wait for their first value */
+		for (int i = 0; i < column_count; ++i) {
+				const char *decltype_str = sqlite3_column_decltype(stmt, i);
+
+				_columns[i].name = sqlite3_column_name(stmt, i);
+				if (decltype_str == NULL)
+						continue;
+
+				switch (handler::affinityOf(decltype_str)) {
+				case handler::Affinity::Integer:
+						setType(_columns[i], ColumnType::Integer);
+						break;
+				case handler::Affinity::Real:
+						setType(_columns[i], ColumnType::Real);
+						break;
+				case handler::Affinity::Text:
+						setType(_columns[i], ColumnType::Text);
+						break;
+				default:
+						break;
+				}
+		}
+
+		while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+				/* A new word of the null bitmaps is needed every 64 rows */
+				if ((_rows & 63) == 0)
+						for (auto &column : _columns)
+								column.nulls.push_back(0);
+
+				for (int i = 0; i < column_count; ++i)
+						appendValue(_columns[i], stmt, i);
+				++_rows;
+		}
+
+		return rc;
+}
+
+/******************************clear*******************************************/
+void handler::ResultSet::clear(){
+		_columns.clear();
+		_rows = 0;
+}
+
+/******************************columnIndex*************************************/
+int handler::ResultSet::columnIndex(std::string_view name) const {
+		for (size_t i = 0; i < _columns.size(); ++i) {
+				if (_columns[i].name == name)
+						return static_cast<int>(i);
+		}
+		return -1;
+}
+
+/******************************getters****************************************/
+int64_t handler::ResultSet::getInt64(size_t row, size_t column) const {
+		const Column &col = _columns[column];
+
+		switch (col.type) {
+		case ColumnType::Integer:
+				return col.integers[row];
+		case ColumnType::Real:
+				return static_cast<int64_t>(col.reals[row]);
+		default:
+				return 0;
+		}
+}
+
+double handler::ResultSet::getDouble(size_t row, size_t column) const {
+		const Column &col = _columns[column];
+
+		switch (col.type) {
+		case ColumnType::Integer:
+				return static_cast<double>(col.integers[row]);
+		case ColumnType::Real:
+				return col.reals[row];
+		default:
+				return 0;
+		}
+}
+
+std::string_view handler::ResultSet::getText(size_t row, size_t column) const {
+		const Column &col = _columns[column];
+
+		if (col.type != ColumnType::Text && col.type != ColumnType::Blob)
+				return std::string_view();
+
+		return std::string_view(col.arena.data() + col.offsets[row], \
+		                        col.offsets[row + 1] - col.offsets[row]);
+}
+
+/******************************appendValue*************************************/
+void handler::ResultSet::appendValue(Column &column, sqlite3_stmt *stmt, int index){
+		int value_type = sqlite3_column_type(stmt, index);
+
+		if (value_type == SQLITE_NULL) {
+				column.nulls[_rows >> 6] |= (uint64_t(1) << (_rows & 63));
+
+				/* Keep one slot per row so the values stay addressable by row */
+				switch (column.type) {
+				case ColumnType::Integer:
+						column.integers.push_back(0);
+						break;
+				case ColumnType::Real:
+						column.reals.push_back(0);
+						break;
+				case ColumnType::Text:
+				case ColumnType::Blob:
+						column.offsets.push_back(column.arena.size());
+						break;
+				default:
+						break;
+				}
+				return;
+		}
+
+		/* Choose the storage with the first value, or widen it if the value does not fit */
+		if (column.type == ColumnType::Null) {
+				switch (value_type) {
+				case SQLITE_INTEGER:
+						setType(column, ColumnType::Integer);
+						break;
+				case SQLITE_FLOAT:
+						setType(column, ColumnType::Real);
+						break;
+				case SQLITE_TEXT:
+						setType(column, ColumnType::Text);
+						break;
+				default:
+						setType(column, ColumnType::Blob);
+						break;
+				}
+		} else if (column.type == ColumnType::Integer && value_type == SQLITE_FLOAT) {
+				setType(column, ColumnType::Real);
+		} else if ((column.type == ColumnType::Integer || column.type == ColumnType::Real) && \
+		           (value_type == SQLITE_TEXT || value_type == SQLITE_BLOB)) {
+				setType(column, ColumnType::Text);
+		}
+
+		switch (column.type) {
+		case ColumnType::Integer:
+				column.integers.push_back(sqlite3_column_int64(stmt, index));
+				break;
+		case ColumnType::Real:
+				column.reals.push_back(sqlite3_column_double(stmt, index));
+				break;
+		case ColumnType::Text: {
+				const unsigned char *text = sqlite3_column_text(stmt, index);
+				column.arena.append(reinterpret_cast<const char*>(text), sqlite3_column_bytes(stmt, index));
+				column.offsets.push_back(column.arena.size());
+				break;
+		}
+		default: {
+				const void *blob = sqlite3_column_blob(stmt, index);
+				int bytes = sqlite3_column_bytes(stmt, index);
+				/* Empty blobs are returned as a NULL pointer */
+				if (bytes > 0)
+						column.arena.append(static_cast<const char*>(blob), bytes);
+				column.offsets.push_back(column.arena.size());
+				break;
+		}
+		}
+}
+
+/******************************setType*****************************************/
+void handler::ResultSet::setType(Column &column, ColumnType type){
+		if (column.type == ColumnType::Null) {
+				/* Every row stored so far was NULL */
+				switch (type) {
+				case ColumnType::Integer:
+						column.integers.assign(_rows, 0);
+						break;
+				case ColumnType::Real:
+						column.reals.assign(_rows, 0);
+						break;
+				default:
+						column.offsets.assign(_rows + 1, 0);
+						break;
+				}
+		} else if (column.type == ColumnType::Integer && type == ColumnType::Real) {
+				column.reals.assign(column.integers.begin(), column.integers.end());
+				std::vector<int64_t>().swap(column.integers);
+		} else {
+				/* A numeric column becomes text, write its values as sqlite3 would */
+				char buffer[32];
+
+				column.offsets.assign(1, 0);
+				for (size_t row = 0; row < _rows; ++row) {
+						if (!isNullBit(column.nulls, row)) {
+								if (column.type == ColumnType::Integer)
+										sqlite3_snprintf(sizeof(buffer), buffer, "%lld", \
+										                 static_cast<sqlite3_int64>(column.integers[row]));
+								else
+										sqlite3_snprintf(sizeof(buffer), buffer, "%!.15g", column.reals[row]);
+								column.arena += buffer;
+						}
+						column.offsets.push_back(column.arena.size());
+				}
+				std::vector<int64_t>().swap(column.integers);
+				std::vector<double>().swap(column.reals);
+		}
+
+		column.type = type;
+}
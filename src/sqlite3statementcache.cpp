@@ -0,0 +1,211 @@
+/*
+ * This file is part of Sqlite3Utils.
+ *
+ * Sqlite3Utils is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Sqlite3Utils is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Sqlite3Utils.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <iterator>
+#include "../include/statement_cache.hpp"
+
+using handler::CachedStatement;
+using handler::StatementCache;
+
+/******************************CachedStatement*********************************/
+
+handler::CachedStatement::~CachedStatement(){
+		release();
+}
+
+handler::CachedStatement::CachedStatement(CachedStatement &&other) noexcept :
+		_cache(other._cache), _stmt(other._stmt), _entry(other._entry) {
+		other._cache = NULL;
+		other._stmt = NULL;
+		other._entry = NULL;
+}
+
+CachedStatement& handler::CachedStatement::operator=(CachedStatement &&other) noexcept {
+		if (this != &other) {
+				release();
+				_cache = other._cache;
+				_stmt = other._stmt;
+				_entry = other._entry;
+				other._cache = NULL;
+				other._stmt = NULL;
+				other._entry = NULL;
+		}
+		return *this;
+}
+
+void handler::CachedStatement::release(){
+		if (_stmt != NULL) {
+				_cache->release(_stmt, static_cast<StatementCache::Entry*>(_entry));
+				_cache = NULL;
+				_stmt = NULL;
+				_entry = NULL;
+		}
+}
+
+/******************************StatementCache**********************************/
+
+handler::StatementCache::StatementCache(size_t capacity) : _capacity(capacity) {
+}
+
+handler::StatementCache::~StatementCache(){
+		clear();
+}
+
+/******************************acquire*****************************************/
+CachedStatement handler::StatementCache::acquire(sqlite3 *db, std::string_view sql, int &rc){
+		sqlite3_stmt *stmt = NULL;
+		bool cacheable;
+
+		{
+				std::lock_guard<std::mutex> lock(_mutex);
+				auto found = _index.find(sql);
+
+				if (found != _index.end() && !found->second->in_use) {
+						/* Hit: move the entry to the front of the LRU list and lend it */
+						_entries.splice(_entries.begin(), _entries, found->second);
+						found->second->in_use = true;
+						++_hits;
+						rc = SQLITE_OK;
+						return CachedStatement(this, found->second->stmt, &*found->second);
+				}
+
+				++_misses;
+				cacheable = (found == _index.end());
+		}
+
+		/* Compile without holding the lock, so other threads can use the cache meanwhile */
+		rc = sqlite3_prepare_v2(db, sql.data(), static_cast<int>(sql.size()), &stmt, NULL);
+		if (rc != SQLITE_OK || stmt == NULL) {
+				/* Empty statements (only comments or spaces) compile to NULL */
+				if (stmt != NULL)
+						sqlite3_finalize(stmt);
+				return CachedStatement();
+		}
+
+		std::lock_guard<std::mutex> lock(_mutex);
+
+		/* A busy copy of the same text already lives in the cache -> private statement.
+		   Another thread may have stored it while this one was compiling */
+		if (_capacity == 0 || !cacheable || _index.find(sql) != _index.end())
+				return CachedStatement(this, stmt, NULL);
+
+		_entries.push_front(Entry{std::string(sql), stmt, true, false});
+		_index.emplace(_entries.front().sql, _entries.begin());
+		evict();
+
+		return CachedStatement(this, stmt, &_entries.front());
+}
+
+/******************************warm********************************************/
+int handler::StatementCache::warm(sqlite3 *db, std::string_view sql){
+		int rc;
+		CachedStatement stmt = acquire(db, sql, rc);
+
+		return rc;
+}
+
+/******************************release*****************************************/
+void handler::StatementCache::release(sqlite3_stmt *stmt, Entry *entry){
+		/* Leave the statement ready for the next execution */
+		sqlite3_reset(stmt);
+		sqlite3_clear_bindings(stmt);
+
+		if (entry == NULL) {
+				sqlite3_finalize(stmt);
+				return;
+		}
+
+		std::lock_guard<std::mutex> lock(_mutex);
+		entry->in_use = false;
+		if (entry->detached) {
+				for (auto it = _detached.begin(); it != _detached.end(); ++it) {
+						if (&*it == entry) {
+								sqlite3_finalize(it->stmt);
+								_detached.erase(it);
+								break;
+						}
+				}
+				return;
+		}
+		/* The capacity may have been reduced while the statement was in use */
+		evict();
+}
+
+/******************************evict*******************************************/
+void handler::StatementCache::evict(){
+		auto it = _entries.end();
+
+		/* Remove the least recently used statements that are not leased */
+		while (_index.size() > _capacity && it != _entries.begin()) {
+				--it;
+				if (!it->in_use) {
+						_index.erase(it->sql);
+						sqlite3_finalize(it->stmt);
+						it = _entries.erase(it);
+						++_evictions;
+				}
+		}
+}
+
+/******************************clear*******************************************/
+void handler::StatementCache::clear(){
+		std::lock_guard<std::mutex> lock(_mutex);
+		_index.clear();
+
+		for (auto it = _entries.begin(); it != _entries.end(); ) {
+				if (it->in_use) {
+						/* Keep the node alive for the lease, it is finalized on release */
+						it->detached = true;
+						auto next = std::next(it);
+						_detached.splice(_detached.end(), _entries, it);
+						it = next;
+				} else {
+						sqlite3_finalize(it->stmt);
+						it = _entries.erase(it);
+				}
+		}
+}
+
+/******************************setCapacity*************************************/
+void handler::StatementCache::setCapacity(size_t capacity){
+		std::lock_guard<std::mutex> lock(_mutex);
+		_capacity = capacity;
+		evict();
+}
+
+/******************************getStats****************************************/
+handler::StatementCacheStats handler::StatementCache::getStats() const {
+		std::lock_guard<std::mutex> lock(_mutex);
+		StatementCacheStats stats;
+
+		stats.hits = _hits;
+		stats.misses = _misses;
+		stats.evictions = _evictions;
+		stats.size = _index.size();
+		stats.capacity = _capacity;
+
+		return stats;
+}
+
+/******************************resetStats**************************************/
+void handler::StatementCache::resetStats(){
+		std::lock_guard<std::mutex> lock(_mutex);
+		_hits = 0;
+		_misses = 0;
+		_evictions = 0;
+}
@@ -0,0 +1,193 @@
+/*
+ * This file is part of Sqlite3Utils.
+ *
+ * Sqlite3Utils is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Sqlite3Utils is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Sqlite3Utils.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include "../include/statement_stats.hpp"
+
+using handler::StatementProfiler;
+using handler::StatementStats;
+
+/* Bucket of the histogram holding a latency: the position of its highest bit */
+static size_t latencyBucket(uint64_t ns){
+		size_t bucket = 0;
+
+		while (ns >>= 1)
+				++bucket;
+		return bucket;
+}
+
+/* Latency below which a fraction of the executions fall, as the upper bound of its bucket */
+static uint64_t percentile(const std::array<uint64_t, handler::latency_buckets> &histogram, \
+                           uint64_t calls, double fraction, uint64_t max_ns){
+		uint64_t target = static_cast<uint64_t>(fraction * calls + 0.5);
+		uint64_t seen = 0;
+
+		for (size_t i = 0; i < histogram.size(); ++i) {
+				seen += histogram[i];
+				if (seen >= target && seen > 0) {
+						uint64_t upper = (i >= 63) ? UINT64_MAX : (uint64_t(2) << i) - 1;
+						return std::min(upper, max_ns);
+				}
+		}
+		return max_ns;
+}
+
+static bool isIdentifierChar(char c){
+		return isalnum(static_cast<unsigned char>(c)) || c == '_' || c == '$';
+}
+
+/******************************attach******************************************/
+void handler::StatementProfiler::attach(sqlite3 *db){
+		sqlite3_trace_v2(db, SQLITE_TRACE_PROFILE | SQLITE_TRACE_ROW, trace, this);
+}
+
+/******************************detach******************************************/
+void handler::StatementProfiler::detach(sqlite3 *db){
+		if (db != NULL)
+				sqlite3_trace_v2(db, 0, NULL, NULL);
+}
+
+/******************************trace*******************************************/
+int handler::StatementProfiler::trace(unsigned type, void *context, void *statement, void *extra){
+		StatementProfiler *profiler = static_cast<StatementProfiler*>(context);
+		sqlite3_stmt *stmt = static_cast<sqlite3_stmt*>(statement);
+
+		if (type == SQLITE_TRACE_ROW) {
+				std::lock_guard<std::mutex> lock(profiler->_mutex);
+				++profiler->_rows[stmt];
+				return 0;
+		}
+
+		/* SQLITE_TRACE_PROFILE: the statement finished, extra holds its run time */
+		uint64_t ns = static_cast<uint64_t>(*static_cast<sqlite3_int64*>(extra));
+		std::string sql = normalize(sqlite3_sql(stmt));
+		std::lock_guard<std::mutex> lock(profiler->_mutex);
+		Entry &entry = profiler->_entries[sql];
+		auto rows = profiler->_rows.find(stmt);
+
+		++entry.calls;
+		entry.total_ns += ns;
+		entry.min_ns = std::min(entry.min_ns, ns);
+		entry.max_ns = std::max(entry.max_ns, ns);
+		++entry.histogram[latencyBucket(ns)];
+		if (rows != profiler->_rows.end()) {
+				entry.rows += rows->second;
+				profiler->_rows.erase(rows);
+		}
+		return 0;
+}
+
+/******************************snapshot****************************************/
+std::vector<StatementStats> handler::StatementProfiler::snapshot() const {
+		std::vector<StatementStats> stats;
+		std::lock_guard<std::mutex> lock(_mutex);
+
+		stats.reserve(_entries.size());
+		for (auto &entry : _entries) {
+				StatementStats statement;
+
+				statement.sql = entry.first;
+				statement.calls = entry.second.calls;
+				statement.rows = entry.second.rows;
+				statement.total_ns = entry.second.total_ns;
+				statement.min_ns = entry.second.min_ns;
+				statement.max_ns = entry.second.max_ns;
+				statement.histogram = entry.second.histogram;
+				statement.p50_ns = percentile(statement.histogram, statement.calls, 0.50, statement.max_ns);
+				statement.p99_ns = percentile(statement.histogram, statement.calls, 0.99, statement.max_ns);
+				stats.push_back(std::move(statement));
+		}
+
+		std::sort(stats.begin(), stats.end(), [](const StatementStats &a, const StatementStats &b) {
+				return a.total_ns > b.total_ns;
+		});
+		return stats;
+}
+
+/******************************reset*******************************************/
+void handler::StatementProfiler::reset(){
+		std::lock_guard<std::mutex> lock(_mutex);
+
+		_entries.clear();
+		_rows.clear();
+}
+
+/******************************normalize***************************************/
+std::string handler::StatementProfiler::normalize(const char *sql){
+		std::string normalized;
+		const char *c = sql;
+
+		if (sql == NULL)
+				return normalized;
+
+		normalized.reserve(strlen(sql));
+		while (*c != '\0') {
+				/* Runs of whitespace become a single space, none at the ends */
+				if (isspace(static_cast<unsigned char>(*c))) {
+						while (isspace(static_cast<unsigned char>(*c)))
+								++c;
+						if (!normalized.empty() && *c != '\0')
+								normalized += ' ';
+						continue;
+				}
+
+				/* String and blob literals */
+				if (*c == '\'' || ((*c == 'x' || *c == 'X') && c[1] == '\'' && \
+				                   (normalized.empty() || !isIdentifierChar(normalized.back())))) {
+						if (*c != '\'')
+								++c;
+						for (++c; *c != '\0'; ++c) {
+								if (*c == '\'' && c[1] == '\'')
+										++c;
+								else if (*c == '\'')
+										break;
+						}
+						if (*c != '\0')
+								++c;
+						normalized += '?';
+						continue;
+				}
+
+				/* Quoted identifiers are kept as they are */
+				if (*c == '"' || *c == '`' || *c == '[') {
+						char end = (*c == '[') ? ']' : *c;
+
+						normalized += *c++;
+						while (*c != '\0' && *c != end)
+								normalized += *c++;
+						if (*c != '\0')
+								normalized += *c++;
+						continue;
+				}
+
+				/* Numeric literals, not the digits inside identifiers */
+				if ((isdigit(static_cast<unsigned char>(*c)) || (*c == '.' && isdigit(static_cast<unsigned char>(c[1])))) && \
+				    (normalized.empty() || !isIdentifierChar(normalized.back()))) {
+						while (isalnum(static_cast<unsigned char>(*c)) || *c == '.' || \
+						       ((*c == '+' || *c == '-') && (c[-1] == 'e' || c[-1] == 'E')))
+								++c;
+						normalized += '?';
+						continue;
+				}
+
+				normalized += *c++;
+		}
+		return normalized;
+}
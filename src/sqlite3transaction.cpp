@@ -0,0 +1,131 @@
+/*
+ * This file is part of Sqlite3Utils.
+ *
+ * Sqlite3Utils is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Sqlite3Utils is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Sqlite3Utils.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <exception>
+#include "../include/transaction.hpp"
+
+using handler::Savepoint;
+using handler::Sqlite3Db;
+using handler::Transaction;
+
+/******************************Transaction*************************************/
+
+handler::Transaction::Transaction(Sqlite3Db &db, TransactionMode mode) :
+		_db(db), _active(false), _exceptions(std::uncaught_exceptions()) {
+		Sqlite3Db::TransactionStatement begin;
+
+		switch (mode) {
+		case TransactionMode::Immediate:
+				begin = Sqlite3Db::begin_immediate;
+				break;
+		case TransactionMode::Exclusive:
+				begin = Sqlite3Db::begin_exclusive;
+				break;
+		default:
+				begin = Sqlite3Db::begin_deferred;
+				break;
+		}
+
+		_active = (_db.runTransactionStatement(begin) == EXIT_SUCCESS);
+}
+
+handler::Transaction::~Transaction(){
+		if (!_active)
+				return;
+
+		/* Leaving the scope because of an exception discards the changes */
+		if (std::uncaught_exceptions() > _exceptions || commit() == EXIT_FAILURE)
+				rollback();
+}
+
+bool handler::Transaction::commit(){
+		if (!_active) {
+				SQLITE3UTILS_LOG_ERROR("Transaction is not active, Commit operation aborted");
+				return EXIT_FAILURE;
+		}
+
+		if (_db.runTransactionStatement(Sqlite3Db::commit_transaction) == EXIT_FAILURE)
+				return EXIT_FAILURE;
+
+		_active = false;
+		return EXIT_SUCCESS;
+}
+
+bool handler::Transaction::rollback(){
+		if (!_active) {
+				SQLITE3UTILS_LOG_ERROR("Transaction is not active, Rollback operation aborted");
+				return EXIT_FAILURE;
+		}
+
+		/* Even if the rollback fails the transaction can not be used anymore */
+		_active = false;
+		return _db.runTransactionStatement(Sqlite3Db::rollback_transaction);
+}
+
+/******************************Savepoint***************************************/
+
+handler::Savepoint::Savepoint(Sqlite3Db &db, const std::string &name) :
+		_db(db), _name(name), _active(false), _exceptions(std::uncaught_exceptions()) {
+
+		_active = (execute(Sqlite3Db::open_savepoint, query::cmd::savepoint) == EXIT_SUCCESS);
+}
+
+handler::Savepoint::~Savepoint(){
+		if (!_active)
+				return;
+
+		/* Leaving the scope because of an exception discards the changes */
+		if (std::uncaught_exceptions() > _exceptions || release() == EXIT_FAILURE)
+				rollback();
+}
+
+bool handler::Savepoint::release(){
+		if (!_active) {
+				SQLITE3UTILS_LOG_ERROR("Savepoint is not active, Release operation aborted");
+				return EXIT_FAILURE;
+		}
+
+		if (execute(Sqlite3Db::release_savepoint, query::cmd::release_savepoint) == EXIT_FAILURE)
+				return EXIT_FAILURE;
+
+		_active = false;
+		return EXIT_SUCCESS;
+}
+
+bool handler::Savepoint::rollback(){
+		if (!_active) {
+				SQLITE3UTILS_LOG_ERROR("Savepoint is not active, Rollback operation aborted");
+				return EXIT_FAILURE;
+		}
+
+		_active = false;
+
+		/* Rolling back to a savepoint keeps it open, so it has to be released afterwards */
+		if (execute(Sqlite3Db::rollback_savepoint, query::cmd::rollback_savepoint) == EXIT_FAILURE)
+				return EXIT_FAILURE;
+		return execute(Sqlite3Db::release_savepoint, query::cmd::release_savepoint);
+}
+
+bool handler::Savepoint::execute(int statement, const std::string &command){
+		/* The default name uses the statements compiled by the handler */
+		if (_name == default_name)
+				return _db.runTransactionStatement(static_cast<Sqlite3Db::TransactionStatement>(statement));
+
+		std::string exec_string = command + _name + query::end_query;
+		return _db.executeQuery(exec_string.c_str());
+}
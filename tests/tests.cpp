@@ -3,8 +3,17 @@
 #include <unistd.h>
 #include <string>
 #include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <thread>
+#include "../include/async.hpp"
+#include "../include/group_commit.hpp"
 #include "../include/handler.hpp"
+#include "../include/numeric_validation.hpp"
+#include "../include/pool.hpp"
 #include "../include/query.hpp"
+#include "../include/static_query.hpp"
+#include "../include/transaction.hpp"
 
 /*!
  * \brief Checks if the file given exists in the directory
@@ -258,6 +267,81 @@ TEST(Insert_Record, Fails_With_Wrong_Datatype){
 		std::vector<std::string> values_to_insert = {"Hello", "32", "435", "Albert"};
 		ASSERT_EQ(UserHandler.insertRecord(table_name, values_to_insert), EXIT_FAILURE);
 }
+/*******************INSERT MANY RECORDS FUNCTION*************************/
+/* Insert many rows, with and without undefined fields, in one call */
+TEST(Insert_Records, Succeeds_With_Mixed_Insertion_Descriptions){
+		handler::Sqlite3Db MemoryHandler(":memory:");
+		ASSERT_EQ(MemoryHandler.createTable(table_name, table_definition), EXIT_SUCCESS);
+
+		std::vector<std::vector<std::string> > rows = {{"1", "32", "665", "ANTHON33"}, \
+				                                           {"2", "43", "", "Julia"}, \
+				                                           {"3", "23", "", "Edu"}};
+		ASSERT_EQ(MemoryHandler.insertRecords(table_name, rows), EXIT_SUCCESS);
+		ASSERT_EQ(MemoryHandler.selectRecords(table_name), data_to_check);
+}
+
+/* Several rows can be packed in the same statement */
+TEST(Insert_Records, Succeeds_Packing_Rows_In_Statements){
+		handler::Sqlite3Db MemoryHandler(":memory:");
+		ASSERT_EQ(MemoryHandler.createTable(table_name, table_definition), EXIT_SUCCESS);
+
+		std::vector<std::vector<std::string> > rows;
+		for (int i = 0; i < 1000; ++i) {
+				rows.push_back({std::to_string(i), "20", std::to_string(i * 3), "Name"});
+		}
+		ASSERT_EQ(MemoryHandler.insertRecords(table_name, rows, 0), EXIT_SUCCESS);
+
+		std::vector<std::string> count;
+		ASSERT_EQ(MemoryHandler.executeQuery("SELECT COUNT(*) FROM CONNECTIONS;", count, {0}), EXIT_SUCCESS);
+		ASSERT_EQ(count[0], "1000");
+}
+
+/* A failing row leaves the table as it was */
+TEST(Insert_Records, Fails_Without_Changes_When_Any_Row_Fails){
+		handler::Sqlite3Db MemoryHandler(":memory:");
+		ASSERT_EQ(MemoryHandler.createTable(table_name, table_definition), EXIT_SUCCESS);
+
+		std::vector<std::vector<std::string> > repeated_key = {{"1", "32", "665", "ANTHON33"}, \
+				                                                   {"1", "43", "", "Julia"}};
+		ASSERT_EQ(MemoryHandler.insertRecords(table_name, repeated_key), EXIT_FAILURE);
+
+		std::vector<std::vector<std::string> > wrong_type = {{"2", "32", "665", "ANTHON33"}, \
+				                                                 {"Hello", "43", "", "Julia"}};
+		ASSERT_EQ(MemoryHandler.insertRecords(table_name, wrong_type), EXIT_FAILURE);
+		ASSERT_TRUE(MemoryHandler.selectRecords(table_name).empty());
+}
+
+/*******************CACHED TYPES OF THE FIELDS***************************/
+/* Inserting a record only executes the insertion itself, the types are already loaded */
+TEST(Record_Validator, Insert_Does_Not_Query_Field_Types){
+		handler::Sqlite3Db MemoryHandler(":memory:");
+		ASSERT_EQ(MemoryHandler.createTable(table_name, table_definition), EXIT_SUCCESS);
+
+		handler::StatementCacheStats before = MemoryHandler.getStatementCacheStats();
+		ASSERT_EQ(MemoryHandler.insertRecord(table_name, {"1", "30", "1", "A"}), EXIT_SUCCESS);
+		handler::StatementCacheStats after = MemoryHandler.getStatementCacheStats();
+		ASSERT_EQ(after.hits + after.misses, before.hits + before.misses + 1);
+}
+
+/* Records are checked against the affinity of each column */
+TEST(Record_Validator, Checks_Each_Field_Affinity){
+		std::vector<handler::ColumnDescriptor> columns;
+
+		for (const char *type : {"INT", "DOUBLE", "CHAR(50)", "NUMERIC"}) {
+				handler::ColumnDescriptor column;
+				column.declared_type = type;
+				column.affinity = handler::affinityOf(type);
+				columns.push_back(column);
+		}
+
+		ASSERT_EQ(handler::validateRecord(columns, {"1", "2.5", "Text", "3,5"}), EXIT_SUCCESS);
+		ASSERT_EQ(handler::validateRecord(columns, {"1", "", "", ""}), EXIT_SUCCESS);
+		ASSERT_EQ(handler::validateRecord(columns, {"1.5", "2.5", "Text", "3"}), EXIT_FAILURE);
+		ASSERT_EQ(handler::validateRecord(columns, {"1", "2a", "Text", "3"}), EXIT_FAILURE);
+		ASSERT_TRUE(columns[2].bindsAsText());
+		ASSERT_FALSE(columns[3].bindsAsText());
+}
+
 /*********************OPERATIONS ON LOADED DB***************************/
 /* Hanlder declarations loads all the information inside of the db (tables and field in the map) */
 TEST(Loaded_Data, Succeeds_Load_Database_Information_Through_Constructor){
@@ -668,6 +752,26 @@ TEST(Select_Records, Succeeds_Select_Struct_Overload_With_No_Condition_Met){
 		ASSERT_TRUE(data.empty());
 }
 
+/* Repeated selects reuse the query composed, and "*" follows the columns added to the table */
+TEST(Select_Records, Reuses_Composed_Query_Until_Columns_Change){
+		handler::Sqlite3Db MemoryHandler(":memory:");
+
+		ASSERT_EQ(MemoryHandler.createTable("T", {{"A", "INT"}, {"B", "TEXT"}}), EXIT_SUCCESS);
+		ASSERT_EQ(MemoryHandler.insertRecord("T", {"1", "one"}), EXIT_SUCCESS);
+
+		std::vector<std::string> first = MemoryHandler.selectRecords("T", {"*"}, false, "A = 1");
+		handler::StatementCacheStats stats = MemoryHandler.getStatementCacheStats();
+		std::vector<std::string> second = MemoryHandler.selectRecords("T", {"*"}, false, "A = 1");
+		ASSERT_EQ(first, std::vector<std::string>({"1", "one"}));
+		ASSERT_EQ(second, first);
+		ASSERT_EQ(MemoryHandler.getStatementCacheStats().hits, stats.hits + 1);
+
+		ASSERT_EQ(MemoryHandler.executeQuery("ALTER TABLE T ADD COLUMN C TEXT DEFAULT 'c';"), EXIT_SUCCESS);
+		ASSERT_EQ(MemoryHandler.updateHandler(), EXIT_SUCCESS);
+		ASSERT_EQ(MemoryHandler.selectRecords("T", {"*"}, false, "A = 1"), \
+		          std::vector<std::string>({"1", "one", "c"}));
+}
+
 /****************UPDATE AND MULTICONNECTION OPERATIONS*************/
 
 /* Update operation when no change has been applied on the db */
@@ -704,6 +808,52 @@ TEST(Update_Handler, Succeeds_Update_With_Parallel_Handler_Changes_On_DB){
 		ASSERT_EQ(NewHandler.getTables(), UserHandler.getTables());
 }
 
+/* The catalog is only loaded again when the schema version changes */
+TEST(Update_Handler, Skips_Catalog_Load_Until_Schema_Changes){
+		handler::Sqlite3Db MemoryHandler(":memory:");
+
+		ASSERT_EQ(MemoryHandler.createTable("T", {{"A", "INT"}}), EXIT_SUCCESS);
+		ASSERT_EQ(MemoryHandler.updateHandler(), EXIT_SUCCESS);
+
+		/* Only the schema version is read */
+		handler::StatementCacheStats before = MemoryHandler.getStatementCacheStats();
+		ASSERT_EQ(MemoryHandler.updateHandler(), EXIT_SUCCESS);
+		handler::StatementCacheStats after = MemoryHandler.getStatementCacheStats();
+		ASSERT_EQ(after.hits + after.misses, before.hits + before.misses + 1);
+
+		ASSERT_EQ(MemoryHandler.executeQuery("CREATE TABLE U (B REAL NOT NULL, C);"), EXIT_SUCCESS);
+		ASSERT_EQ(MemoryHandler.updateHandler(), EXIT_SUCCESS);
+		std::vector<handler::ColumnDescriptor> columns = MemoryHandler.getColumns("U");
+		ASSERT_EQ(columns.size(), 2u);
+		ASSERT_EQ(columns[0].affinity, handler::Affinity::Real);
+		ASSERT_TRUE(columns[0].not_null);
+		ASSERT_EQ(columns[1].affinity, handler::Affinity::Blob);
+		ASSERT_EQ(MemoryHandler.getFields("T"), std::vector<std::string>({"A"}));
+}
+
+/* Loading a catalog with more tables than the cache holds keeps the statements of the user */
+TEST(Update_Handler, Catalog_Load_Does_Not_Evict_Cached_Statements){
+		handler::Sqlite3Db MemoryHandler(":memory:");
+
+		for (int i = 0; i < 100; ++i) {
+				std::string table = "CREATE TABLE T" + std::to_string(i) + " (A INT, B TEXT);";
+				ASSERT_EQ(MemoryHandler.executeQuery(table.c_str()), EXIT_SUCCESS);
+		}
+		ASSERT_EQ(MemoryHandler.updateHandler(), EXIT_SUCCESS);
+		ASSERT_EQ(MemoryHandler.executeQuery("SELECT 1;"), EXIT_SUCCESS);
+		ASSERT_EQ(MemoryHandler.executeQuery("CREATE TABLE T100 (A INT, B TEXT);"), EXIT_SUCCESS);
+
+		/* The whole catalog is loaded again, without touching the cached statements */
+		handler::StatementCacheStats before = MemoryHandler.getStatementCacheStats();
+		ASSERT_EQ(MemoryHandler.updateHandler(), EXIT_SUCCESS);
+		ASSERT_EQ(MemoryHandler.getFields("T100"), std::vector<std::string>({"A", "B"}));
+		ASSERT_EQ(MemoryHandler.executeQuery("SELECT 1;"), EXIT_SUCCESS);
+		handler::StatementCacheStats after = MemoryHandler.getStatementCacheStats();
+		/* The schema version, the names of the tables and the query of the user hit the cache */
+		ASSERT_EQ(after.evictions, before.evictions);
+		ASSERT_EQ(after.hits, before.hits + 3);
+}
+
 /*****************************EXECUTE QUERY********************************/
 /* Custom query wanting no output */
 TEST(Execute_Custom_Query, Succeeds_With_Correct_Query_Syntax){
@@ -743,6 +893,1281 @@ TEST(Execute_Custom_Query, Returns_Empty_With_Incorrect_Data_Index){
 		ASSERT_TRUE(data_vec.empty());
 }
 
+/*****************************STATEMENT CACHE******************************/
+/* Executing the same query twice reuses the compiled statement */
+TEST(Statement_Cache, Reuses_Statement_On_Repeated_Query){
+		handler::Sqlite3Db CacheHandler("MyDB.db");
+		std::string query = query::cmd::select + "NAME" + query::cl::from + table_name;
+		std::vector<std::string> first, second;
+
+		ASSERT_EQ(CacheHandler.executeQuery(query.c_str(), first, {0}), EXIT_SUCCESS);
+		handler::StatementCacheStats stats = CacheHandler.getStatementCacheStats();
+		ASSERT_EQ(CacheHandler.executeQuery(query.c_str(), second, {0}), EXIT_SUCCESS);
+
+		ASSERT_EQ(first, second);
+		ASSERT_EQ(CacheHandler.getStatementCacheStats().hits, stats.hits + 1);
+		ASSERT_EQ(CacheHandler.getStatementCacheStats().misses, stats.misses);
+}
+
+/* Statements prepared in advance are served from the cache, also after a reconnection */
+TEST(Statement_Cache, Prepared_Statements_Survive_Reconnection){
+		handler::Sqlite3Db CacheHandler("MyDB.db");
+		std::string query = query::cmd::select + "AGE" + query::cl::from + table_name;
+
+		ASSERT_EQ(CacheHandler.prepareStatements({query}), EXIT_SUCCESS);
+		CacheHandler.closeConnection();
+		ASSERT_EQ(CacheHandler.connectDb(), EXIT_SUCCESS);
+
+		handler::StatementCacheStats stats = CacheHandler.getStatementCacheStats();
+		ASSERT_EQ(CacheHandler.executeQuery(query.c_str()), EXIT_SUCCESS);
+		ASSERT_EQ(CacheHandler.getStatementCacheStats().hits, stats.hits + 1);
+}
+
+/* Preparing a wrong statement reports the failure */
+TEST(Statement_Cache, Fails_Prepare_With_Incorrect_Query_Syntax){
+		handler::Sqlite3Db CacheHandler("MyDB.db");
+		std::string query = query::cmd::select + query::cl::from + table_name;
+
+		ASSERT_EQ(CacheHandler.prepareStatements({query}), EXIT_FAILURE);
+}
+
+/* The cache never grows over its capacity, and a capacity of 0 disables it */
+TEST(Statement_Cache, Respects_Capacity){
+		handler::Sqlite3Db CacheHandler("MyDB.db");
+		std::string query = query::cmd::select + "ID" + query::cl::from + table_name;
+
+		CacheHandler.setStatementCacheSize(1);
+		ASSERT_EQ(CacheHandler.executeQuery(query.c_str()), EXIT_SUCCESS);
+		ASSERT_EQ(CacheHandler.getStatementCacheStats().size, 1);
+
+		CacheHandler.setStatementCacheSize(0);
+		handler::StatementCacheStats stats = CacheHandler.getStatementCacheStats();
+		ASSERT_EQ(stats.size, 0);
+		ASSERT_EQ(CacheHandler.executeQuery(query.c_str()), EXIT_SUCCESS);
+		ASSERT_EQ(CacheHandler.getStatementCacheStats().hits, stats.hits);
+}
+
+/*****************************TRANSACTIONS*********************************/
+/* Changes are kept when the transaction is committed */
+TEST(Transactions, Commit_Keeps_Changes){
+		handler::Sqlite3Db MemoryHandler(":memory:");
+		ASSERT_EQ(MemoryHandler.createTable(table_name, table_definition), EXIT_SUCCESS);
+		{
+				handler::Transaction transaction(MemoryHandler, handler::TransactionMode::Immediate);
+				ASSERT_TRUE(transaction.isActive());
+				ASSERT_EQ(MemoryHandler.insertRecord(table_name, {"1", "30", "1", "A"}), EXIT_SUCCESS);
+				ASSERT_EQ(transaction.commit(), EXIT_SUCCESS);
+				ASSERT_FALSE(transaction.isActive());
+		}
+		ASSERT_EQ(MemoryHandler.selectRecords(table_name, {"NAME"}), std::vector<std::string>({"A"}));
+}
+
+/* Changes are discarded when the transaction is rolled back, or left through an exception */
+TEST(Transactions, Rollback_Discards_Changes){
+		handler::Sqlite3Db MemoryHandler(":memory:");
+		ASSERT_EQ(MemoryHandler.createTable(table_name, table_definition), EXIT_SUCCESS);
+		{
+				handler::Transaction transaction(MemoryHandler);
+				ASSERT_EQ(MemoryHandler.insertRecord(table_name, {"1", "30", "1", "A"}), EXIT_SUCCESS);
+				ASSERT_EQ(transaction.rollback(), EXIT_SUCCESS);
+		}
+		try {
+				handler::Transaction transaction(MemoryHandler, handler::TransactionMode::Exclusive);
+				MemoryHandler.insertRecord(table_name, {"2", "30", "1", "B"});
+				throw std::runtime_error("abort");
+		} catch (const std::runtime_error &) {
+		}
+		ASSERT_TRUE(MemoryHandler.selectRecords(table_name).empty());
+}
+
+/* The scope of a transaction commits it when it ends normally */
+TEST(Transactions, Scope_End_Commits){
+		handler::Sqlite3Db MemoryHandler(":memory:");
+		ASSERT_EQ(MemoryHandler.createTable(table_name, table_definition), EXIT_SUCCESS);
+		{
+				handler::Transaction transaction(MemoryHandler);
+				ASSERT_EQ(MemoryHandler.insertRecord(table_name, {"1", "30", "1", "A"}), EXIT_SUCCESS);
+		}
+		ASSERT_EQ(MemoryHandler.selectRecords(table_name, {"ID"}), std::vector<std::string>({"1"}));
+}
+
+/* Nested savepoints discard only their own changes */
+TEST(Transactions, Nested_Savepoints_Rollback_Independently){
+		handler::Sqlite3Db MemoryHandler(":memory:");
+		ASSERT_EQ(MemoryHandler.createTable(table_name, table_definition), EXIT_SUCCESS);
+		{
+				handler::Transaction transaction(MemoryHandler);
+				handler::Savepoint outer(MemoryHandler);
+				ASSERT_EQ(MemoryHandler.insertRecord(table_name, {"1", "30", "1", "A"}), EXIT_SUCCESS);
+				{
+						handler::Savepoint inner(MemoryHandler);
+						ASSERT_EQ(MemoryHandler.insertRecord(table_name, {"2", "30", "1", "B"}), EXIT_SUCCESS);
+						ASSERT_EQ(inner.rollback(), EXIT_SUCCESS);
+				}
+				{
+						handler::Savepoint named(MemoryHandler, "named_savepoint");
+						ASSERT_EQ(MemoryHandler.insertRecord(table_name, {"3", "30", "1", "C"}), EXIT_SUCCESS);
+				}
+				ASSERT_EQ(outer.release(), EXIT_SUCCESS);
+				ASSERT_EQ(transaction.commit(), EXIT_SUCCESS);
+		}
+		ASSERT_EQ(MemoryHandler.selectRecords(table_name, {"ID"}), std::vector<std::string>({"1", "3"}));
+}
+
+/* Transactions can not begin on a closed connection */
+TEST(Transactions, Fails_When_Disconnected){
+		handler::Sqlite3Db MemoryHandler(":memory:");
+		MemoryHandler.closeConnection();
+		handler::Transaction transaction(MemoryHandler);
+		ASSERT_FALSE(transaction.isActive());
+		ASSERT_EQ(transaction.commit(), EXIT_FAILURE);
+}
+
+/*****************************BOUND PARAMETERS*****************************/
+/* Values are bound instead of pasted, so text keeps its exact content */
+TEST(Bound_Parameters, Insert_Keeps_Text_Values_Unchanged){
+		handler::Sqlite3Db MemoryHandler(":memory:");
+		ASSERT_EQ(MemoryHandler.createTable(table_name, table_definition), EXIT_SUCCESS);
+
+		std::vector<std::string> values_to_insert = {"1", "30", "", "O'Brien 007"};
+		ASSERT_EQ(MemoryHandler.insertRecord(table_name, values_to_insert), EXIT_SUCCESS);
+
+		std::vector<std::string> data = MemoryHandler.selectRecords(table_name, {"NAME"});
+		ASSERT_EQ(data, std::vector<std::string>({"O'Brien 007"}));
+}
+
+/* The same insert statement is compiled once and reused for every row */
+TEST(Bound_Parameters, Insert_Reuses_Statement_For_Every_Row){
+		handler::Sqlite3Db MemoryHandler(":memory:");
+		ASSERT_EQ(MemoryHandler.createTable(table_name, table_definition), EXIT_SUCCESS);
+		ASSERT_EQ(MemoryHandler.insertRecord(table_name, {"1", "30", "1", "A"}), EXIT_SUCCESS);
+
+		handler::StatementCacheStats stats = MemoryHandler.getStatementCacheStats();
+		ASSERT_EQ(MemoryHandler.insertRecord(table_name, {"2", "31", "2", "B"}), EXIT_SUCCESS);
+		ASSERT_EQ(MemoryHandler.getStatementCacheStats().misses, stats.misses);
+}
+
+/* Update and delete accept values bound to the placeholders of their conditions */
+TEST(Bound_Parameters, Update_And_Delete_With_Bound_Condition){
+		handler::Sqlite3Db MemoryHandler(":memory:");
+		ASSERT_EQ(MemoryHandler.createTable(table_name, table_definition), EXIT_SUCCESS);
+		ASSERT_EQ(MemoryHandler.insertRecord(table_name, {"1", "30", "1", "A"}), EXIT_SUCCESS);
+		ASSERT_EQ(MemoryHandler.insertRecord(table_name, {"2", "50", "2", "B"}), EXIT_SUCCESS);
+
+		ASSERT_EQ(MemoryHandler.updateTable(table_name, {{"NAME", "' OR 1=1 --"}}, "AGE > ?", \
+		                                    {"40"}), EXIT_SUCCESS);
+		std::vector<std::string> names = MemoryHandler.selectRecords(table_name, {"NAME"});
+		ASSERT_EQ(names, std::vector<std::string>({"A", "' OR 1=1 --"}));
+
+		ASSERT_EQ(MemoryHandler.deleteRecords(table_name, "NAME = ?", {"A"}), EXIT_SUCCESS);
+		ASSERT_EQ(MemoryHandler.selectRecords(table_name, {"ID"}), std::vector<std::string>({"2"}));
+}
+
+/* Binding more values than placeholders is an error */
+TEST(Bound_Parameters, Fails_When_Too_Many_Values){
+		handler::Sqlite3Db MemoryHandler(":memory:");
+		ASSERT_EQ(MemoryHandler.createTable(table_name, table_definition), EXIT_SUCCESS);
+		ASSERT_EQ(MemoryHandler.deleteRecords(table_name, "ID = ?", {"1", "2"}), EXIT_FAILURE);
+}
+
+/******************************RESULT SET**********************************/
+/* Numbers are stored in their own type and NULL values keep their place */
+TEST(Result_Set, Select_Stores_Typed_Columns){
+		handler::Sqlite3Db MemoryHandler(":memory:");
+		handler::select_query_param options;
+		handler::ResultSet result;
+
+		ASSERT_EQ(MemoryHandler.createTable(table_name, table_definition), EXIT_SUCCESS);
+		ASSERT_EQ(MemoryHandler.insertRecords(table_name, {{"1", "30", "", "Anna"}, {"2", "40", "555", "Bob"}}), EXIT_SUCCESS);
+
+		options.table_name = table_name;
+		options.order_by = {"ID"};
+		ASSERT_EQ(MemoryHandler.selectRecords(options, result), EXIT_SUCCESS);
+		ASSERT_EQ(result.rowCount(), 2);
+		ASSERT_EQ(result.columnCount(), 4);
+		ASSERT_EQ(result.columnIndex("PHONE"), 2);
+		ASSERT_EQ(result.columnType(1), handler::ColumnType::Integer);
+		ASSERT_EQ(result.columnType(3), handler::ColumnType::Text);
+		ASSERT_EQ(result.integers(1), std::vector<int64_t>({30, 40}));
+		ASSERT_TRUE(result.isNull(0, 2));
+		ASSERT_FALSE(result.isNull(1, 2));
+		ASSERT_EQ(result.getInt64(1, 2), 555);
+		ASSERT_EQ(result.getText(1, 3), "Bob");
+}
+
+/* A column without declared type widens its storage when the values need it */
+TEST(Result_Set, Expression_Columns_Widen_Their_Storage){
+		handler::Sqlite3Db MemoryHandler(":memory:");
+		handler::ResultSet result;
+
+		ASSERT_EQ(MemoryHandler.executeQuery("SELECT NULL AS V UNION ALL SELECT 1 UNION ALL SELECT 2.5 UNION ALL SELECT 'x';", result), EXIT_SUCCESS);
+		ASSERT_EQ(result.rowCount(), 4);
+		ASSERT_EQ(result.columnType(0), handler::ColumnType::Text);
+		ASSERT_TRUE(result.isNull(0, 0));
+		ASSERT_EQ(result.getText(1, 0), "1.0");
+		ASSERT_EQ(result.getText(2, 0), "2.5");
+		ASSERT_EQ(result.getText(3, 0), "x");
+
+		ASSERT_EQ(MemoryHandler.executeQuery("SELECT 1 AS V UNION ALL SELECT 2.5;", result), EXIT_SUCCESS);
+		ASSERT_EQ(result.columnType(0), handler::ColumnType::Real);
+		ASSERT_EQ(result.reals(0), std::vector<double>({1.0, 2.5}));
+}
+
+/* Errors leave the result set empty */
+TEST(Result_Set, Fails_With_Wrong_Query){
+		handler::Sqlite3Db MemoryHandler(":memory:");
+		handler::select_query_param options;
+		handler::ResultSet result;
+
+		ASSERT_EQ(MemoryHandler.executeQuery("SELECT 1;", result), EXIT_SUCCESS);
+		ASSERT_EQ(MemoryHandler.executeQuery("SELEC 1;", result), EXIT_FAILURE);
+		ASSERT_EQ(result.rowCount(), 0);
+		ASSERT_EQ(result.columnCount(), 0);
+
+		options.table_name = "MISSING";
+		ASSERT_EQ(MemoryHandler.selectRecords(options, result), EXIT_FAILURE);
+}
+
+/********************************CURSOR************************************/
+/* The cursor reads every row, one at a time */
+TEST(Cursor, Iterates_Rows_With_Range_For){
+		handler::Sqlite3Db MemoryHandler(":memory:");
+		handler::select_query_param options;
+		std::vector<std::vector<std::string> > rows;
+		int64_t sum = 0;
+		int count = 0;
+
+		ASSERT_EQ(MemoryHandler.createTable(table_name, table_definition), EXIT_SUCCESS);
+		for (int i = 1; i <= 500; ++i)
+				rows.push_back({std::to_string(i), std::to_string(i % 50), "", "Name" + std::to_string(i)});
+		ASSERT_EQ(MemoryHandler.insertRecords(table_name, rows, 0), EXIT_SUCCESS);
+
+		options.table_name = table_name;
+		options.fields = {"ID", "NAME"};
+		options.order_by = {"ID"};
+		handler::Cursor cursor = MemoryHandler.openCursor(options);
+		ASSERT_TRUE(cursor.isOpen());
+		for (const handler::RowView &row : cursor) {
+				++count;
+				sum += row.getInt64(0);
+				ASSERT_EQ(row.getText(1), "Name" + std::to_string(row.getInt64(0)));
+		}
+		ASSERT_EQ(count, 500);
+		ASSERT_EQ(sum, 500 * 501 / 2);
+		ASSERT_EQ(cursor.getResultCode(), SQLITE_DONE);
+		ASSERT_FALSE(cursor.isOpen());
+}
+
+/* Stopping early gives the statement back for the next cursor */
+TEST(Cursor, Reuses_Statement_After_Early_Stop){
+		handler::Sqlite3Db MemoryHandler(":memory:");
+		const char *sql = "WITH RECURSIVE s(value) AS (SELECT 1 UNION ALL SELECT value + 1 FROM s LIMIT 1000000) SELECT value FROM s;";
+
+		for (int round = 0; round < 2; ++round) {
+				handler::Cursor cursor = MemoryHandler.openCursor(sql);
+				ASSERT_TRUE(cursor.next());
+				ASSERT_EQ(cursor.row().getInt64(0), 1);
+				ASSERT_TRUE(cursor.next());
+				ASSERT_EQ(cursor.row().getInt64(0), 2);
+		}
+		handler::StatementCacheStats stats = MemoryHandler.getStatementCacheStats();
+		ASSERT_GE(stats.hits, 1);
+}
+
+/* Wrong queries give a closed cursor with no rows */
+TEST(Cursor, Fails_With_Wrong_Query){
+		handler::Sqlite3Db MemoryHandler(":memory:");
+		handler::select_query_param options;
+
+		options.table_name = "MISSING";
+		handler::Cursor cursor = MemoryHandler.openCursor(options);
+		ASSERT_FALSE(cursor.isOpen());
+		ASSERT_TRUE(cursor.begin() == cursor.end());
+		ASSERT_FALSE(MemoryHandler.openCursor("SELEC 1;").isOpen());
+}
+
+/******************************FOR EACH ROW********************************/
+/* The row view exposes the type and the raw bytes of each value */
+TEST(For_Each_Row, Reads_Typed_Values_Without_Copies){
+		handler::Sqlite3Db MemoryHandler(":memory:");
+		int rows = 0;
+
+		ASSERT_EQ(MemoryHandler.forEachRow("SELECT 7, 1.5, 'text', x'00FF', NULL;", \
+		                                   [&](const handler::RowView &row) {
+				++rows;
+				EXPECT_EQ(row.columnCount(), 5);
+				EXPECT_EQ(row.columnType(0), handler::ColumnType::Integer);
+				EXPECT_EQ(row.getInt64(0), 7);
+				EXPECT_EQ(row.columnType(1), handler::ColumnType::Real);
+				EXPECT_EQ(row.getDouble(1), 1.5);
+				EXPECT_EQ(row.columnType(2), handler::ColumnType::Text);
+				EXPECT_EQ(row.getText(2), "text");
+				EXPECT_EQ(row.columnType(3), handler::ColumnType::Blob);
+				handler::BlobView blob = row.getBlob(3);
+				EXPECT_EQ(blob.size, 2);
+				EXPECT_EQ(blob.data[1], 0xFF);
+				EXPECT_TRUE(row.isNull(4));
+				EXPECT_TRUE(row.getText(4).empty());
+				return true;
+		}), EXIT_SUCCESS);
+		ASSERT_EQ(rows, 1);
+}
+
+/* Returning false from the function stops the execution */
+TEST(For_Each_Row, Stops_When_Function_Returns_False){
+		handler::Sqlite3Db MemoryHandler(":memory:");
+		int64_t last = 0;
+
+		ASSERT_EQ(MemoryHandler.forEachRow("WITH RECURSIVE s(v) AS (SELECT 1 UNION ALL SELECT v + 1 FROM s) SELECT v FROM s;", \
+		                                   [&](const handler::RowView &row) {
+				last = row.getInt64(0);
+				return last < 10;
+		}), EXIT_SUCCESS);
+		ASSERT_EQ(last, 10);
+		ASSERT_EQ(MemoryHandler.forEachRow("SELEC 1;", [](const handler::RowView&) {
+				return true;
+		}), EXIT_FAILURE);
+}
+
+/****************************CONNECTION POOL*******************************/
+/* Tables created through one handler are known by the rest */
+TEST(Connection_Pool, Shares_Schema_Between_Handlers){
+		std::remove("PoolDB.db");
+		handler::Sqlite3DbPool pool("PoolDB.db", 3);
+		ASSERT_TRUE(pool.isConnected());
+		ASSERT_EQ(pool.size(), 3);
+
+		handler::PooledDb first = pool.acquire();
+		handler::PooledDb second = pool.acquire();
+		ASSERT_NE(first.get(), second.get());
+
+		ASSERT_EQ(first->createTable(table_name, table_definition), EXIT_SUCCESS);
+		ASSERT_EQ(second->getFields(table_name), names_to_check);
+		ASSERT_EQ(second->insertRecord(table_name, {"1", "30", "", "Anna"}), EXIT_SUCCESS);
+		ASSERT_EQ(first->selectRecords(table_name, {"NAME"}), std::vector<std::string>({"Anna"}));
+
+		std::vector<std::string> journal_mode;
+		ASSERT_EQ(first->executeQuery("PRAGMA journal_mode;", journal_mode, {0}), EXIT_SUCCESS);
+		ASSERT_EQ(journal_mode, std::vector<std::string>({"wal"}));
+}
+
+/* Only the first handler loads the catalog, the rest open with the schema it loaded */
+TEST(Connection_Pool, Loads_Schema_Once){
+		handler::Sqlite3DbPool pool("PoolDB.db", 4);
+		std::vector<handler::PooledDb> leases;
+		int loaded = 0;
+
+		for (int i = 0; i < 4; ++i)
+				leases.push_back(pool.acquire());
+		for (auto &lease : leases) {
+				if (lease->getStatementCacheStats().misses > 0)
+						++loaded;
+				ASSERT_EQ(lease->getFields(table_name), names_to_check);
+		}
+		ASSERT_EQ(loaded, 1);
+}
+
+/* A path that can not be opened leaves the handlers disconnected, without freeing them */
+TEST(Connection_Pool, Reports_Database_That_Can_Not_Be_Opened){
+		handler::Sqlite3Db Handler("/nonexistent_dir/x.db");
+		ASSERT_FALSE(Handler.isConnected());
+		ASSERT_EQ(Handler.insertRecord(table_name, {"1", "30", "", "Anna"}), EXIT_FAILURE);
+
+		handler::Sqlite3DbPool pool("/nonexistent_dir/x.db", 2);
+		ASSERT_FALSE(pool.isConnected());
+		handler::PooledDb lease = pool.tryAcquire();
+		ASSERT_TRUE(static_cast<bool>(lease));
+		ASSERT_FALSE(lease->isConnected());
+}
+
+/* Threads holding different leases read at the same time */
+TEST(Connection_Pool, Parallel_Reads_With_Leases){
+		handler::Sqlite3DbPool pool("PoolDB.db", 4);
+		std::vector<std::vector<std::string> > rows;
+		std::vector<std::thread> workers;
+		std::vector<size_t> read(4, 0);
+
+		for (int i = 2; i <= 1000; ++i)
+				rows.push_back({std::to_string(i), "40", "", "Name"});
+		{
+				handler::PooledDb db = pool.acquire();
+				ASSERT_EQ(db->insertRecords(table_name, rows, 0), EXIT_SUCCESS);
+		}
+
+		for (size_t t = 0; t < read.size(); ++t) {
+				workers.emplace_back([&pool, &read, t] {
+						for (int i = 0; i < 10; ++i) {
+								handler::PooledDb db = pool.acquire();
+								read[t] += db->selectRecords(table_name, {"ID"}).size();
+						}
+				});
+		}
+		for (auto &worker : workers)
+				worker.join();
+
+		for (size_t count : read)
+				ASSERT_EQ(count, 10 * 1000);
+		handler::PoolStats stats = pool.getStats();
+		ASSERT_EQ(stats.acquisitions, 41);
+		ASSERT_EQ(stats.idle, 4);
+}
+
+/* Acquisitions wait for a handler, or give up when asked to */
+TEST(Connection_Pool, Counts_Waits_And_Timeouts){
+		handler::Sqlite3DbPool pool("PoolDB.db", 1);
+		handler::PooledDb held = pool.acquire();
+
+		ASSERT_FALSE(pool.tryAcquire());
+		ASSERT_FALSE(pool.acquire(std::chrono::milliseconds(5)));
+
+		std::thread releaser([&held] {
+				std::this_thread::sleep_for(std::chrono::milliseconds(20));
+				held.release();
+		});
+		handler::PooledDb waited = pool.acquire();
+		releaser.join();
+		ASSERT_TRUE(waited);
+
+		handler::PoolStats stats = pool.getStats();
+		ASSERT_EQ(stats.acquisitions, 2);
+		ASSERT_EQ(stats.timeouts, 1);
+		ASSERT_EQ(stats.waits, 1);
+		ASSERT_GT(stats.max_wait_ns, 0);
+}
+
+/***************************CONCURRENT READERS******************************/
+/* One handler is shared by several threads selecting at the same time */
+TEST(Concurrent_Readers, Parallel_Selects_On_Shared_Handler){
+		handler::Sqlite3Db MemoryHandler(":memory:");
+		std::vector<std::vector<std::string> > rows;
+		std::vector<std::thread> workers;
+		std::vector<int> failures(4, 0);
+
+		ASSERT_EQ(MemoryHandler.createTable(table_name, table_definition), EXIT_SUCCESS);
+		for (int i = 1; i <= 200; ++i)
+				rows.push_back({std::to_string(i), std::to_string(i % 7), "", "Name"});
+		ASSERT_EQ(MemoryHandler.insertRecords(table_name, rows, 0), EXIT_SUCCESS);
+
+		for (size_t t = 0; t < failures.size(); ++t) {
+				workers.emplace_back([&MemoryHandler, &failures, t] {
+						handler::select_query_param options;
+						options.table_name = table_name;
+						options.fields = {"ID"};
+						options.where_cond = "AGE = " + std::to_string(t);
+
+						for (int i = 0; i < 50; ++i) {
+								if (MemoryHandler.selectRecords(options).size() != ((t == 0) ? 28 : 29))
+										++failures[t];
+								if (MemoryHandler.selectRecords(table_name, {"NAME"}).size() != 200)
+										++failures[t];
+						}
+				});
+		}
+		for (auto &worker : workers)
+				worker.join();
+
+		ASSERT_EQ(failures, std::vector<int>(4, 0));
+}
+
+/* Looking for an unknown table does not change the schema */
+TEST(Concurrent_Readers, Unknown_Table_Lookups_Do_Not_Modify_Schema){
+		handler::Sqlite3Db MemoryHandler(":memory:");
+
+		ASSERT_TRUE(MemoryHandler.getFields("MISSING").empty());
+		ASSERT_TRUE(MemoryHandler.selectRecords("MISSING").empty());
+		ASSERT_EQ(MemoryHandler.getNumTables(), 0);
+}
+
+/*****************************OPEN OPTIONS*********************************/
+/* The settings of the options are in place once the handler is built */
+TEST(Open_Options, Applies_Settings_At_Open){
+		std::remove("OptionsDB.db");
+		handler::OpenOptions options = handler::OpenOptions::throughput();
+		options.page_size = 8192;
+		handler::Sqlite3Db OptionsHandler("OptionsDB.db", options);
+		std::vector<std::string> data;
+
+		ASSERT_TRUE(OptionsHandler.isConnected());
+		ASSERT_EQ(OptionsHandler.executeQuery("PRAGMA journal_mode;", data, {0}), EXIT_SUCCESS);
+		ASSERT_EQ(data, std::vector<std::string>({"wal"}));
+		ASSERT_EQ(OptionsHandler.executeQuery("PRAGMA synchronous;", data, {0}), EXIT_SUCCESS);
+		ASSERT_EQ(data, std::vector<std::string>({"1"}));
+		ASSERT_EQ(OptionsHandler.executeQuery("PRAGMA cache_size;", data, {0}), EXIT_SUCCESS);
+		ASSERT_EQ(data, std::vector<std::string>({"-65536"}));
+		ASSERT_EQ(OptionsHandler.executeQuery("PRAGMA temp_store;", data, {0}), EXIT_SUCCESS);
+		ASSERT_EQ(data, std::vector<std::string>({"2"}));
+		ASSERT_EQ(OptionsHandler.executeQuery("PRAGMA page_size;", data, {0}), EXIT_SUCCESS);
+		ASSERT_EQ(data, std::vector<std::string>({"8192"}));
+}
+
+/* Reconnecting with other options applies them to the new connection */
+TEST(Open_Options, Reconnect_With_New_Options){
+		handler::Sqlite3Db OptionsHandler("OptionsDB.db");
+		std::vector<std::string> data;
+
+		ASSERT_EQ(OptionsHandler.connectDb(handler::OpenOptions::durable()), EXIT_FAILURE);
+		OptionsHandler.closeConnection();
+		ASSERT_EQ(OptionsHandler.connectDb(handler::OpenOptions::durable()), EXIT_SUCCESS);
+		ASSERT_EQ(OptionsHandler.executeQuery("PRAGMA synchronous;", data, {0}), EXIT_SUCCESS);
+		ASSERT_EQ(data, std::vector<std::string>({"2"}));
+}
+
+/* Read only connections can not write, nor create the database */
+TEST(Open_Options, Read_Only_Connections){
+		handler::Sqlite3Db OptionsHandler("OptionsDB.db");
+		handler::OpenOptions options;
+
+		OptionsHandler.closeConnection();
+		options.flags = SQLITE_OPEN_READONLY | SQLITE_OPEN_FULLMUTEX;
+		ASSERT_EQ(OptionsHandler.connectDb(options), EXIT_SUCCESS);
+		ASSERT_EQ(OptionsHandler.executeQuery("CREATE TABLE T (A INT);"), EXIT_FAILURE);
+
+		/* Once the file is gone, the connection can not be opened without SQLITE_OPEN_CREATE */
+		OptionsHandler.closeConnection();
+		std::remove("OptionsDB.db");
+		ASSERT_EQ(OptionsHandler.connectDb(options), EXIT_FAILURE);
+		ASSERT_FALSE(OptionsHandler.isConnected());
+		ASSERT_FALSE(exists("OptionsDB.db"));
+}
+
+/*******************ASYNC QUERIES*******************************************/
+/* Operations run in order on the worker and their results reach the futures */
+TEST(Async_Queries, Results_Are_Delivered_In_Order){
+		handler::AsyncSqlite3Db AsyncHandler(":memory:", 4);
+
+		ASSERT_TRUE(AsyncHandler.isConnected());
+		auto created = AsyncHandler.submit([](handler::Sqlite3Db &db) {
+				return db.createTable(table_name, table_definition);
+		});
+		auto inserted = AsyncHandler.insertRecord(table_name, {"1", "30", "555", "Ann"});
+		auto updated = AsyncHandler.updateTable(table_name, {{"AGE", "31"}}, "ID = 1");
+		auto bound = AsyncHandler.executeQuery("SELECT NAME, AGE FROM " + table_name + " WHERE ID = ?;", {"1"}, {0, 1});
+
+		handler::select_query_param select_options;
+		select_options.table_name = table_name;
+		select_options.fields = {"NAME"};
+		auto selected = AsyncHandler.selectRecords(select_options);
+
+		ASSERT_EQ(created.get(), EXIT_SUCCESS);
+		ASSERT_EQ(inserted.get(), EXIT_SUCCESS);
+		ASSERT_EQ(updated.get(), EXIT_SUCCESS);
+		handler::QueryResult result = bound.get();
+		ASSERT_EQ(result.status, EXIT_SUCCESS);
+		ASSERT_EQ(result.data, std::vector<std::string>({"Ann", "31"}));
+		ASSERT_EQ(selected.get(), std::vector<std::string>({"Ann"}));
+		ASSERT_EQ(AsyncHandler.executeQuery("SELEC 1;").get().status, EXIT_FAILURE);
+}
+
+/* A full queue makes trySubmit() give up instead of waiting */
+TEST(Async_Queries, Queue_Depth_Is_Bounded){
+		handler::AsyncSqlite3Db AsyncHandler(":memory:", 2);
+		std::promise<void> gate;
+		std::shared_future<void> opened = gate.get_future().share();
+
+		/* The worker is held by the first job, so the next ones stay queued */
+		auto blocking = AsyncHandler.submit([opened](handler::Sqlite3Db&) {
+				opened.wait();
+				return 0;
+		});
+		while (AsyncHandler.pending() > 0)
+				std::this_thread::yield();
+
+		auto first = AsyncHandler.trySubmit([](handler::Sqlite3Db&) { return 1; });
+		auto second = AsyncHandler.trySubmit([](handler::Sqlite3Db&) { return 2; });
+		auto rejected = AsyncHandler.trySubmit([](handler::Sqlite3Db&) { return 3; });
+		ASSERT_TRUE(first.valid());
+		ASSERT_TRUE(second.valid());
+		ASSERT_FALSE(rejected.valid());
+		ASSERT_EQ(AsyncHandler.pending(), AsyncHandler.queueDepth());
+
+		gate.set_value();
+		ASSERT_EQ(blocking.get(), 0);
+		ASSERT_EQ(first.get(), 1);
+		ASSERT_EQ(second.get(), 2);
+}
+
+/* Jobs queued when the handler is destroyed still run */
+TEST(Async_Queries, Destruction_Runs_Queued_Jobs){
+		std::future<int> last;
+		{
+				handler::AsyncSqlite3Db AsyncHandler(":memory:");
+				for (int i = 0; i < 10; ++i)
+						last = AsyncHandler.submit([i](handler::Sqlite3Db&) {
+								return i;
+						});
+		}
+		ASSERT_EQ(last.get(), 9);
+}
+
+/* A database that can not be opened makes the jobs fail, instead of the worker */
+TEST(Async_Queries, Jobs_Fail_When_Database_Can_Not_Be_Opened){
+		handler::AsyncSqlite3Db AsyncHandler("/nonexistent_dir/x.db");
+
+		ASSERT_FALSE(AsyncHandler.isConnected());
+		ASSERT_EQ(AsyncHandler.insertRecord(table_name, {"1", "30", "", "Anna"}).get(), EXIT_FAILURE);
+		ASSERT_EQ(AsyncHandler.executeQuery("SELECT 1;").get().status, EXIT_FAILURE);
+}
+
+/*******************GROUP COMMIT********************************************/
+/* Writes of many threads are committed together, and each caller hears about its own */
+TEST(Group_Commit, Batches_Writes_Of_Many_Threads){
+		std::remove("GroupCommitDB.db");
+		std::vector<std::thread> producers;
+		std::atomic<int> succeeded(0);
+		{
+				handler::GroupCommitWriter Writer("GroupCommitDB.db", 64, std::chrono::milliseconds(5));
+
+				ASSERT_TRUE(Writer.isConnected());
+				ASSERT_EQ(Writer.submit([](handler::Sqlite3Db &db) {
+						return db.createTable(table_name, table_definition);
+				}).get(), EXIT_SUCCESS);
+
+				for (int t = 0; t < 4; ++t) {
+						producers.emplace_back([&Writer, &succeeded, t] {
+								std::vector<std::future<bool> > done;
+								for (int i = 0; i < 50; ++i) {
+										std::string id = std::to_string(t * 50 + i);
+										done.push_back(Writer.insertRecord(table_name, {id, "20", "555", "Name" + id}));
+								}
+								for (auto &result : done)
+										if (result.get() == EXIT_SUCCESS)
+												++succeeded;
+						});
+				}
+				for (auto &producer : producers)
+						producer.join();
+
+				handler::GroupCommitStats stats = Writer.getStats();
+				ASSERT_EQ(stats.writes, 201u);
+				ASSERT_EQ(stats.failed, 0u);
+				ASSERT_LT(stats.batches, stats.writes);
+				ASSERT_GT(stats.max_batch, 1u);
+		}
+		ASSERT_EQ(succeeded, 200);
+
+		handler::Sqlite3Db CheckHandler("GroupCommitDB.db");
+		std::vector<std::string> data;
+		ASSERT_EQ(CheckHandler.executeQuery(("SELECT COUNT(*) FROM " + table_name + ";").c_str(), data, {0}), EXIT_SUCCESS);
+		ASSERT_EQ(data, std::vector<std::string>({"200"}));
+}
+
+/* A failing write is rolled back alone, the rest of its batch is committed */
+TEST(Group_Commit, Failed_Writes_Do_Not_Affect_The_Batch){
+		std::remove("GroupCommitFailDB.db");
+		{
+				handler::Sqlite3Db SetupHandler("GroupCommitFailDB.db");
+
+				ASSERT_EQ(SetupHandler.createTable(table_name, table_definition), EXIT_SUCCESS);
+				ASSERT_EQ(SetupHandler.insertRecord(table_name, {"1", "30", "", "Anna"}), EXIT_SUCCESS);
+				ASSERT_EQ(SetupHandler.insertRecord(table_name, {"2", "40", "", "Ben"}), EXIT_SUCCESS);
+		}
+		handler::GroupCommitWriter Writer("GroupCommitFailDB.db", 3, std::chrono::milliseconds(200));
+
+		auto good = Writer.insertRecord(table_name, {"1000", "20", "555", "Good"});
+		auto bad = Writer.submit([](handler::Sqlite3Db &db) {
+				db.executeQuery(("DELETE FROM " + table_name + ";").c_str());
+				return EXIT_FAILURE;
+		});
+		auto updated = Writer.updateTable(table_name, {{"AGE", "21"}}, "ID = 1000");
+
+		ASSERT_EQ(good.get(), EXIT_SUCCESS);
+		ASSERT_EQ(bad.get(), EXIT_FAILURE);
+		ASSERT_EQ(updated.get(), EXIT_SUCCESS);
+		ASSERT_EQ(Writer.getStats().batches, 1u);
+		ASSERT_EQ(Writer.submit([](handler::Sqlite3Db &db) {
+				std::vector<std::string> data;
+				db.executeQuery(("SELECT ID, AGE FROM " + table_name + " ORDER BY ID;").c_str(), data, {0, 1});
+				return (data == std::vector<std::string>({"1", "30", "2", "40", "1000", "21"})) ? EXIT_SUCCESS : EXIT_FAILURE;
+		}).get(), EXIT_SUCCESS);
+}
+
+/* Writes pushed while a batch is committed are split in batches of max_batch at most */
+TEST(Group_Commit, Batches_Never_Exceed_Max_Batch){
+		std::remove("GroupCommitSplitDB.db");
+		handler::GroupCommitWriter Writer("GroupCommitSplitDB.db", 4, std::chrono::microseconds(0));
+		std::promise<void> started, release;
+		std::shared_future<void> released = release.get_future().share();
+		std::vector<std::future<bool> > done;
+
+		ASSERT_EQ(Writer.submit([](handler::Sqlite3Db &db) {
+				return db.createTable(table_name, table_definition);
+		}).get(), EXIT_SUCCESS);
+
+		/* The writer is kept busy until every write is pushed */
+		auto blocking = Writer.submit([&started, released](handler::Sqlite3Db&) {
+				started.set_value();
+				released.wait();
+				return EXIT_SUCCESS;
+		});
+		started.get_future().wait();
+		for (int i = 0; i < 20; ++i) {
+				std::string id = std::to_string(i);
+				done.push_back(Writer.insertRecord(table_name, {id, "20", "555", "Name" + id}));
+		}
+		release.set_value();
+
+		ASSERT_EQ(blocking.get(), EXIT_SUCCESS);
+		for (auto &result : done)
+				ASSERT_EQ(result.get(), EXIT_SUCCESS);
+		handler::GroupCommitStats stats = Writer.getStats();
+		ASSERT_EQ(stats.max_batch, 4u);
+		ASSERT_EQ(stats.batches, 7u);
+}
+
+/* A writer whose database can not be opened fails its writes */
+TEST(Group_Commit, Writes_Fail_When_Database_Can_Not_Be_Opened){
+		handler::GroupCommitWriter Writer("/nonexistent_dir/x.db");
+
+		ASSERT_FALSE(Writer.isConnected());
+		ASSERT_EQ(Writer.insertRecord(table_name, {"1", "30", "", "Anna"}).get(), EXIT_FAILURE);
+		ASSERT_EQ(Writer.getStats().batches, 0u);
+}
+
+/*******************MEMORY MAPPING******************************************/
+/* Scans read the pages with xRead without memory mapping, and from the mapping with it */
+TEST(Memory_Mapping, Counts_Reads_And_Mmap_Hits){
+		std::remove("MmapDB.db");
+		handler::OpenOptions options;
+		options.cache_size = 8;
+		options.count_io = true;
+		handler::Sqlite3Db MmapHandler("MmapDB.db", options);
+		size_t rows = 0;
+		auto count_rows = [&rows](const handler::RowView&) {
+				++rows;
+				return true;
+		};
+
+		ASSERT_EQ(MmapHandler.executeQuery("CREATE TABLE DATA (ID INTEGER PRIMARY KEY, NAME TEXT);"), EXIT_SUCCESS);
+		ASSERT_EQ(MmapHandler.executeQuery("WITH RECURSIVE C(X) AS (SELECT 1 UNION ALL SELECT X + 1 FROM C WHERE X < 2000) " \
+		                                   "INSERT INTO DATA SELECT X, printf('%0200d', X) FROM C;"), EXIT_SUCCESS);
+
+		ASSERT_EQ(MmapHandler.setMmapSize(0), EXIT_SUCCESS);
+		ASSERT_EQ(MmapHandler.getMmapSize(), 0);
+		MmapHandler.resetIoStats();
+		ASSERT_EQ(MmapHandler.forEachRow("SELECT NAME FROM DATA;", count_rows), EXIT_SUCCESS);
+		handler::IoStats pread_stats = MmapHandler.getIoStats();
+		ASSERT_EQ(rows, 2000u);
+		ASSERT_GT(pread_stats.reads, 0u);
+		ASSERT_GT(pread_stats.read_bytes, 0u);
+		ASSERT_EQ(pread_stats.fetch_hits, 0u);
+
+		ASSERT_EQ(MmapHandler.setMmapSize(64 * 1024 * 1024), EXIT_SUCCESS);
+		ASSERT_GT(MmapHandler.getMmapSize(), 0);
+		MmapHandler.resetIoStats();
+		ASSERT_EQ(MmapHandler.forEachRow("SELECT NAME FROM DATA;", count_rows), EXIT_SUCCESS);
+		handler::IoStats mmap_stats = MmapHandler.getIoStats();
+		ASSERT_EQ(rows, 4000u);
+		ASSERT_GT(mmap_stats.fetch_hits, 0u);
+		ASSERT_LT(mmap_stats.reads, pread_stats.reads);
+
+		/* Without the option the reads are not counted */
+		handler::Sqlite3Db MemoryHandler(":memory:");
+		ASSERT_EQ(MemoryHandler.getIoStats().reads, 0u);
+}
+
+/* Immutable files are opened read only and can be queried */
+TEST(Memory_Mapping, Immutable_Files_Are_Read_Only){
+		handler::OpenOptions options = handler::OpenOptions::readMostly();
+		options.immutable = true;
+		handler::Sqlite3Db ImmutableHandler("MmapDB.db", options);
+		std::vector<std::string> data;
+
+		ASSERT_TRUE(ImmutableHandler.isConnected());
+		ASSERT_EQ(ImmutableHandler.executeQuery("SELECT COUNT(*) FROM DATA;", data, {0}), EXIT_SUCCESS);
+		ASSERT_EQ(data, std::vector<std::string>({"2000"}));
+		ASSERT_EQ(ImmutableHandler.executeQuery("DELETE FROM DATA;"), EXIT_FAILURE);
+		ASSERT_GT(ImmutableHandler.getMmapSize(), 0);
+}
+
+/*******************STATEMENT STATS*****************************************/
+/* Literals are replaced so the same query with other values is grouped */
+TEST(Statement_Stats, Normalizes_Literals){
+		ASSERT_EQ(handler::StatementProfiler::normalize("SELECT  NAME FROM T1\n WHERE ID = 12 AND NAME = 'it''s' OR B = x'00FF' OR R = 1.5e-3;"), \
+		          "SELECT NAME FROM T1 WHERE ID = ? AND NAME = ? OR B = ? OR R = ?;");
+		ASSERT_EQ(handler::StatementProfiler::normalize("SELECT \"COL 1\" FROM T WHERE A IN (?, :v, 3)"), \
+		          "SELECT \"COL 1\" FROM T WHERE A IN (?, :v, ?)");
+}
+
+/* Executions are counted per normalized statement, only when the library measures them */
+TEST(Statement_Stats, Counts_Executions){
+		handler::Sqlite3Db MemoryHandler(":memory:");
+		std::vector<std::string> data;
+
+		MemoryHandler.executeQuery("CREATE TABLE T (ID INTEGER PRIMARY KEY, V TEXT);");
+		MemoryHandler.executeQuery("INSERT INTO T VALUES (1, 'a'), (2, 'b'), (3, 'c');");
+		MemoryHandler.resetStatementStats();
+		for (int i = 1; i <= 3; ++i)
+				MemoryHandler.executeQuery(("SELECT V FROM T WHERE ID >= " + std::to_string(i) + ";").c_str(), data, {0});
+
+		std::vector<handler::StatementStats> stats = MemoryHandler.getStatementStats();
+#ifdef SQLITE3UTILS_STATEMENT_STATS
+		auto select = std::find_if(stats.begin(), stats.end(), [](const handler::StatementStats &s) {
+				return s.sql == "SELECT V FROM T WHERE ID >= ?;";
+		});
+		ASSERT_NE(select, stats.end());
+		ASSERT_EQ(select->calls, 3u);
+		ASSERT_EQ(select->rows, 6u);
+		ASSERT_LE(select->min_ns, select->p50_ns);
+		ASSERT_LE(select->p50_ns, select->p99_ns);
+		ASSERT_LE(select->p99_ns, select->max_ns);
+
+		MemoryHandler.resetStatementStats();
+		ASSERT_TRUE(MemoryHandler.getStatementStats().empty());
+#else
+		ASSERT_TRUE(stats.empty());
+#endif
+}
+
+/*******************LOGGER**************************************************/
+/* Sink keeping the messages it receives */
+class CaptureSink : public handler::LogSink {
+public:
+		void write(handler::LogLevel level, const char *message) override {
+				messages.emplace_back(level, message);
+		};
+
+		std::vector<std::pair<handler::LogLevel, std::string> > messages;
+};
+
+/* Only the messages at or above the level set reach the sink */
+TEST(Logger, Messages_Are_Filtered_By_Level){
+		auto sink = std::make_shared<CaptureSink>();
+		handler::Sqlite3Db MemoryHandler(":memory:");
+
+		ASSERT_EQ(handler::log::getLevel(), handler::LogLevel::Warning);
+		handler::log::setSink(sink);
+		ASSERT_EQ(MemoryHandler.createTable(table_name, table_definition), EXIT_SUCCESS);
+		ASSERT_TRUE(sink->messages.empty());
+
+		handler::log::setLevel(handler::LogLevel::Info);
+		ASSERT_EQ(MemoryHandler.insertRecord(table_name, {"1", "20", "555", "Ann"}), EXIT_SUCCESS);
+		ASSERT_EQ(sink->messages.size(), 1u);
+		ASSERT_EQ(sink->messages[0].first, handler::LogLevel::Info);
+		ASSERT_EQ(sink->messages[0].second, "Records created successfully.");
+
+		ASSERT_EQ(MemoryHandler.executeQuery("SELEC 1;"), EXIT_FAILURE);
+		ASSERT_EQ(sink->messages.size(), 2u);
+		ASSERT_EQ(sink->messages[1].first, handler::LogLevel::Error);
+
+		handler::log::setLevel(handler::LogLevel::Warning);
+		handler::log::setSink(std::make_shared<handler::ConsoleSink>());
+}
+
+/* A null sink discards everything, and long messages are not truncated */
+TEST(Logger, Null_Sink_And_Long_Messages){
+		auto sink = std::make_shared<CaptureSink>();
+		std::string long_text(2000, 'x');
+
+		handler::log::setSink(sink);
+		SQLITE3UTILS_LOG_ERROR("%s", long_text.c_str());
+		ASSERT_EQ(sink->messages.size(), 1u);
+		ASSERT_EQ(sink->messages[0].second, long_text);
+
+		handler::log::setSink(nullptr);
+		SQLITE3UTILS_LOG_ERROR("discarded");
+		ASSERT_EQ(sink->messages.size(), 1u);
+
+		handler::log::setSink(std::make_shared<handler::ConsoleSink>());
+}
+
+/*******************STATIC QUERIES**************************/
+
+/* The sql is composed by the compiler */
+TEST(Static_Query, Composes_Sql_At_Compile_Time){
+		static constexpr auto select = query::fixed::select("NAME", "AGE").from("USERS").where("AGE > ?") \
+		                               .orderBy("AGE DESC", "NAME").limit<10>().offset();
+		static constexpr auto grouped = query::fixed::select("AGE", "COUNT(*)").from("USERS") \
+		                                .groupBy("AGE").having("COUNT(*) > 1");
+		static constexpr auto insert = query::fixed::insertInto("USERS", "NAME", "AGE");
+		static constexpr auto update = query::fixed::update("USERS").set("NAME", "AGE").where("ID = ?");
+		static constexpr auto remove = query::fixed::deleteFrom("USERS").where("ID = ?");
+
+		static_assert(select.view() == "SELECT NAME, AGE FROM USERS WHERE AGE > ? ORDER BY AGE DESC, NAME LIMIT 10 OFFSET ?", "");
+		static_assert(grouped.view() == "SELECT AGE, COUNT(*) FROM USERS GROUP BY AGE HAVING COUNT(*) > 1", "");
+		static_assert(insert.view() == "INSERT INTO USERS (NAME, AGE) VALUES (?, ?)", "");
+		static_assert(update.view() == "UPDATE USERS SET NAME = ?, AGE = ? WHERE ID = ?", "");
+		static_assert(remove.view() == "DELETE FROM USERS WHERE ID = ?", "");
+		ASSERT_EQ(strlen(select.c_str()), select.size());
+}
+
+/* The queries run through executeQuery(), which keeps their statements in the cache */
+TEST(Static_Query, Executes_From_Statement_Cache){
+		static constexpr auto insert = query::fixed::insertInto("PEOPLE", "ID", "NAME");
+		static constexpr auto select = query::fixed::select("NAME").from("PEOPLE").where("ID = ?");
+		handler::Sqlite3Db MemoryHandler(":memory:");
+		std::vector<std::string> data;
+
+		ASSERT_EQ(MemoryHandler.executeQuery("CREATE TABLE PEOPLE (ID INT PRIMARY KEY, NAME TEXT);"), EXIT_SUCCESS);
+		ASSERT_EQ(MemoryHandler.executeQuery(insert, {"1", "Ann"}, data), EXIT_SUCCESS);
+		ASSERT_EQ(MemoryHandler.executeQuery(insert, {"2", "Bob"}, data), EXIT_SUCCESS);
+
+		handler::StatementCacheStats stats = MemoryHandler.getStatementCacheStats();
+		ASSERT_EQ(MemoryHandler.executeQuery(select, {"2"}, data, {0}), EXIT_SUCCESS);
+		ASSERT_EQ(data, std::vector<std::string>({"Bob"}));
+		ASSERT_EQ(MemoryHandler.executeQuery(select, {"1"}, data, {0}), EXIT_SUCCESS);
+		ASSERT_EQ(data, std::vector<std::string>({"Ann"}));
+		ASSERT_EQ(MemoryHandler.getStatementCacheStats().hits, stats.hits + 1);
+}
+
+/*******************PREPARED QUERIES**************************/
+
+/* Values are bound and read in their own type, reusing the same statement */
+TEST(Prepared_Query, Binds_And_Reads_Typed_Values){
+		handler::Sqlite3Db MemoryHandler(":memory:");
+		const unsigned char bytes[] = {0x00, 0x01, 0xFF};
+		handler::BlobView blob;
+
+		blob.data = bytes;
+		blob.size = sizeof(bytes);
+		ASSERT_EQ(MemoryHandler.executeQuery("CREATE TABLE ITEMS (ID INT, PRICE REAL, NAME TEXT, DATA BLOB);"), EXIT_SUCCESS);
+
+		handler::PreparedQuery insert = MemoryHandler.prepare("INSERT INTO ITEMS VALUES (?, ?, ?, ?);");
+		ASSERT_TRUE(insert.isValid());
+		ASSERT_EQ(insert.parameterCount(), 4);
+		for (int64_t id = 1; id <= 3; ++id) {
+				ASSERT_EQ(insert.bind(1, id * 10000000000), EXIT_SUCCESS);
+				ASSERT_EQ(insert.bind(2, 0.5 * id), EXIT_SUCCESS);
+				ASSERT_EQ(insert.bind(3, std::string("item") + std::to_string(id)), EXIT_SUCCESS);
+				ASSERT_EQ((id == 2) ? insert.bind(4, nullptr) : insert.bind(4, blob), EXIT_SUCCESS);
+				ASSERT_FALSE(insert.step());
+				ASSERT_EQ(insert.getResultCode(), SQLITE_DONE);
+				insert.reset();
+		}
+
+		handler::PreparedQuery select = MemoryHandler.prepare("SELECT ID, PRICE, NAME, DATA FROM ITEMS WHERE ID >= :min ORDER BY ID;");
+		ASSERT_EQ(select.bind(":min", int64_t(20000000000)), EXIT_SUCCESS);
+		ASSERT_TRUE(select.step());
+		ASSERT_EQ(select.getInt64(0), 20000000000);
+		ASSERT_DOUBLE_EQ(select.getDouble(1), 1.0);
+		ASSERT_EQ(select.getText(2), "item2");
+		ASSERT_TRUE(select.isNull(3));
+		ASSERT_TRUE(select.step());
+		ASSERT_EQ(select.getBlob(3).size, sizeof(bytes));
+		ASSERT_EQ(memcmp(select.getBlob(3).data, bytes, sizeof(bytes)), 0);
+		ASSERT_FALSE(select.step());
+		ASSERT_EQ(select.getResultCode(), SQLITE_DONE);
+
+		/* The values bound are kept after a reset */
+		select.reset();
+		ASSERT_TRUE(select.step());
+		ASSERT_EQ(select.getText(2), "item2");
+}
+
+/* Integers of every width and signedness are bound as 64 bit integers */
+TEST(Prepared_Query, Binds_Any_Integer_Type){
+		handler::Sqlite3Db MemoryHandler(":memory:");
+		std::vector<int> values = {1, 2, 3};
+		sqlite3_int64 big = 10000000000;
+		unsigned short small = 7;
+
+		handler::PreparedQuery query = MemoryHandler.prepare("SELECT ?1, ?2, :small;");
+		ASSERT_EQ(query.bind(1, big), EXIT_SUCCESS);
+		ASSERT_EQ(query.bind(2, values.size()), EXIT_SUCCESS);
+		ASSERT_EQ(query.bind(":small", small), EXIT_SUCCESS);
+		ASSERT_TRUE(query.step());
+		ASSERT_EQ(query.getInt64(0), big);
+		ASSERT_EQ(query.getInt64(1), 3);
+		ASSERT_EQ(query.getInt64(2), 7);
+}
+
+/* A query that does not compile is reported, and binding to a wrong parameter fails */
+TEST(Prepared_Query, Fails_With_Wrong_Query_Or_Parameter){
+		handler::Sqlite3Db MemoryHandler(":memory:");
+
+		handler::PreparedQuery wrong = MemoryHandler.prepare("SELEC 1;");
+		ASSERT_FALSE(wrong.isValid());
+		ASSERT_EQ(wrong.bind(1, 1), EXIT_FAILURE);
+		ASSERT_FALSE(wrong.step());
+
+		handler::PreparedQuery query = MemoryHandler.prepare("SELECT ?;");
+		ASSERT_TRUE(query.isValid());
+		ASSERT_EQ(query.bind(2, 1), EXIT_FAILURE);
+		ASSERT_EQ(query.bind(":missing", "text"), EXIT_FAILURE);
+		ASSERT_EQ(query.bind(1, "text"), EXIT_SUCCESS);
+		ASSERT_TRUE(query.step());
+		ASSERT_EQ(query.getText(0), "text");
+}
+
+/*******************TYPED ROWS**************************/
+
+struct MappedItem {
+		int64_t id;
+		std::optional<double> price;
+		std::string name;
+};
+
+namespace handler {
+template <>
+struct RowMapping<MappedItem> {
+		static constexpr auto fields = std::make_tuple(&MappedItem::id, &MappedItem::price, &MappedItem::name);
+};
+}
+
+/* Rows are read into tuples and structs, with NULL kept apart by std::optional */
+TEST(Typed_Rows, Selects_Into_Tuples_And_Structs){
+		handler::Sqlite3Db MemoryHandler(":memory:");
+		handler::select_query_param options;
+		std::vector<std::tuple<int64_t, double, std::string> > tuples;
+		std::vector<MappedItem> items;
+
+		ASSERT_EQ(MemoryHandler.createTable("ITEMS", {{"ID", "INT"}, {"PRICE", "REAL"}, {"NAME", "TEXT"}}), EXIT_SUCCESS);
+		ASSERT_EQ(MemoryHandler.executeQuery("INSERT INTO ITEMS VALUES (1, 2.5, 'pen'), (2, NULL, 'cap'), (3, 10, 'ink');"), EXIT_SUCCESS);
+
+		options.table_name = "ITEMS";
+		options.fields = {"ID", "PRICE", "NAME"};
+		options.order_by = {"ID"};
+		ASSERT_EQ(MemoryHandler.selectAs(options, tuples), EXIT_SUCCESS);
+		ASSERT_EQ(tuples.size(), 3u);
+		ASSERT_EQ(tuples[0], std::make_tuple(int64_t(1), 2.5, std::string("pen")));
+		ASSERT_EQ(tuples[1], std::make_tuple(int64_t(2), 0.0, std::string("cap")));
+
+		options.limit = 2;
+		ASSERT_EQ(MemoryHandler.selectAs(options, items), EXIT_SUCCESS);
+		ASSERT_EQ(items.size(), 2u);
+		ASSERT_GE(items.capacity(), 2u);
+		ASSERT_EQ(items[0].id, 1);
+		ASSERT_EQ(items[0].price, 2.5);
+		ASSERT_EQ(items[0].name, "pen");
+		ASSERT_FALSE(items[1].price.has_value());
+
+		/* A huge limit does not reserve room for all of it */
+		std::vector<MappedItem> unbounded;
+		options.limit = std::numeric_limits<int>::max();
+		ASSERT_EQ(MemoryHandler.selectAs(options, unbounded), EXIT_SUCCESS);
+		ASSERT_EQ(unbounded.size(), 3u);
+		ASSERT_LE(unbounded.capacity(), 4096u);
+
+		ASSERT_EQ(MemoryHandler.queryAs("SELECT ID, PRICE, NAME FROM ITEMS WHERE ID = 3;", items), EXIT_SUCCESS);
+		ASSERT_EQ(items.size(), 1u);
+		ASSERT_EQ(items[0].price, 10.0);
+}
+
+/* Mapping more columns than the query returns is reported */
+TEST(Typed_Rows, Fails_When_Query_Has_Less_Columns){
+		handler::Sqlite3Db MemoryHandler(":memory:");
+		std::vector<std::tuple<int64_t, std::string> > rows;
+
+		ASSERT_EQ(MemoryHandler.queryAs("SELECT 1;", rows), EXIT_FAILURE);
+		ASSERT_TRUE(rows.empty());
+		ASSERT_EQ(MemoryHandler.queryAs("SELECT 1, 'one';", rows), EXIT_SUCCESS);
+		ASSERT_EQ(rows, (std::vector<std::tuple<int64_t, std::string> >{{1, "one"}}));
+}
+
+/*******************BULK VALIDATION**************************/
+
+/* Every instruction set gives the same result as checking one character at a time */
+TEST(Bulk_Validation, Matches_Per_Character_Checks){
+		handler::SimdLevel previous = handler::validation::getSimdLevel();
+		const char bad_chars[] = {'a', ' ', '+', '-', '/', ':', '\x80', '\xFF', '\0'};
+
+		for (int level = 0; level <= 2; ++level) {
+				handler::validation::setSimdLevel(static_cast<handler::SimdLevel>(level));
+
+				for (size_t length = 1; length <= 70; ++length) {
+						std::string digits(length, '7');
+						std::string real = digits;
+
+						real[length / 2] = (length % 2) ? '.' : ',';
+						ASSERT_TRUE(handler::Sqlite3Db::isValidInt(digits)) << length;
+						ASSERT_TRUE(handler::Sqlite3Db::isValidReal(digits)) << length;
+						ASSERT_TRUE(handler::Sqlite3Db::isValidReal(real)) << length;
+						ASSERT_FALSE(handler::Sqlite3Db::isValidInt(real)) << length;
+
+						/* A single wrong character anywhere makes the value invalid */
+						for (size_t position = 0; position < length; ++position) {
+								for (char bad : bad_chars) {
+										std::string value = digits;
+
+										value[position] = bad;
+										ASSERT_FALSE(handler::Sqlite3Db::isValidInt(value)) << length << " " << position;
+										ASSERT_FALSE(handler::Sqlite3Db::isValidReal(value)) << length << " " << position;
+								}
+						}
+				}
+				ASSERT_FALSE(handler::Sqlite3Db::isValidInt(""));
+				ASSERT_FALSE(handler::Sqlite3Db::isValidReal(""));
+		}
+		handler::validation::setSimdLevel(previous);
+}
+
+/* A column is checked against its affinity, reporting the wrong values */
+TEST(Bulk_Validation, Validates_Column_Against_Affinity){
+		std::vector<std::string> values = {"12", "", "3.5", "12345678901234567890123456789012345", "x", "NULL"};
+		std::vector<size_t> invalid;
+
+		ASSERT_EQ(handler::validation::validateColumn("INTEGER", values, invalid), 4u);
+		ASSERT_EQ(invalid, std::vector<size_t>({1, 2, 4, 5}));
+		ASSERT_EQ(handler::validation::validateColumn("NUMERIC", values, invalid), 3u);
+		ASSERT_EQ(invalid, std::vector<size_t>({1, 4, 5}));
+		ASSERT_EQ(handler::validation::validateColumn("NULL", values, invalid), 5u);
+		ASSERT_EQ(handler::validation::validateColumn("TEXT", values, invalid), 0u);
+		ASSERT_TRUE(invalid.empty());
+}
+
+/*******************COLUMN DESCRIPTORS**************************/
+
+/* The affinity enum follows the same rules as the affinity tokens */
+TEST(Column_Descriptors, Affinity_Matches_Affinity_Token){
+		for (std::string type : {"INT", "medint", "Short double", "FLOATING POINT", "char(90)", "ClOb", \
+		                         "blob", "", "NUMERIC", "DECIMAL(10,5)", "NULL"})
+				ASSERT_EQ(handler::affinityName(handler::affinityOf(type)), handler::Sqlite3Db::getAffinity(type)) << type;
+
+		ASSERT_EQ(handler::affinityOf("CHARINT"), handler::Affinity::Integer);
+		ASSERT_EQ(handler::affinityFromName("NUMERIC"), handler::Affinity::Numeric);
+		ASSERT_EQ(handler::affinityFromName("UNKNOWN"), handler::Affinity::Text);
+		ASSERT_TRUE(handler::Sqlite3Db::isAffined(handler::Affinity::Numeric, "3,5"));
+		ASSERT_FALSE(handler::Sqlite3Db::isAffined(handler::Affinity::Null, "3"));
+}
+
+/* Constraints of the columns are loaded together with their names and types */
+TEST(Column_Descriptors, Loads_Constraints_Of_Each_Column){
+		handler::Sqlite3Db MemoryHandler(":memory:");
+
+		ASSERT_EQ(MemoryHandler.createTable("ORDERS", {{"ID", "INTEGER NOT NULL PRIMARY KEY"}, {"LINE", "INT"}, \
+		                                               {"PRICE", "DOUBLE DEFAULT 1.5"}, {"NOTE", "VARCHAR(20)"}, \
+		                                               {"DATA", ""}}), EXIT_SUCCESS);
+
+		std::vector<handler::ColumnDescriptor> columns = MemoryHandler.getColumns("ORDERS");
+		ASSERT_EQ(columns.size(), 5u);
+		ASSERT_EQ(columns[0].name, "ID");
+		ASSERT_EQ(columns[0].declared_type, "INTEGER");
+		ASSERT_EQ(columns[0].affinity, handler::Affinity::Integer);
+		ASSERT_TRUE(columns[0].not_null);
+		ASSERT_EQ(columns[0].primary_key, 1);
+		ASSERT_EQ(columns[1].primary_key, 0);
+		ASSERT_FALSE(columns[1].not_null);
+		ASSERT_EQ(columns[2].affinity, handler::Affinity::Real);
+		ASSERT_EQ(columns[2].default_value, std::optional<std::string>("1.5"));
+		ASSERT_EQ(columns[3].affinity, handler::Affinity::Text);
+		ASSERT_FALSE(columns[3].default_value.has_value());
+		ASSERT_EQ(columns[4].affinity, handler::Affinity::Blob);
+		ASSERT_TRUE(columns[4].bindsAsText());
+		ASSERT_EQ(MemoryHandler.getFields("ORDERS"), std::vector<std::string>({"ID", "LINE", "PRICE", "NOTE", "DATA"}));
+		ASSERT_TRUE(MemoryHandler.getColumns("MISSING").empty());
+
+		ASSERT_EQ(MemoryHandler.insertRecord("ORDERS", {"1", "1", "2,5", "Note", "x"}), EXIT_SUCCESS);
+		ASSERT_EQ(MemoryHandler.insertRecord("ORDERS", {"2", "2", "2a", "Note", "x"}), EXIT_FAILURE);
+}
+
+/*******************TABLE CHANGES**************************/
+
+/* Each commit reports the rowids changed on the tables listened to */
+TEST(Table_Changes, Reports_Rowids_Of_Each_Commit){
+		handler::Sqlite3Db MemoryHandler(":memory:");
+		std::vector<handler::TableChange> changes, every_table;
+
+		ASSERT_EQ(MemoryHandler.createTable("T", {{"A", "INT"}}), EXIT_SUCCESS);
+		ASSERT_EQ(MemoryHandler.createTable("U", {{"B", "INT"}}), EXIT_SUCCESS);
+		size_t id = MemoryHandler.onTableChanged("T", [&changes](const handler::TableChange &change) {
+				changes.push_back(change);
+		});
+		MemoryHandler.onTableChanged("", [&every_table](const handler::TableChange &change) {
+				every_table.push_back(change);
+		});
+
+		ASSERT_EQ(MemoryHandler.executeQuery("INSERT INTO U VALUES (1);"), EXIT_SUCCESS);
+		ASSERT_TRUE(changes.empty());
+		ASSERT_EQ(every_table.size(), 1u);
+		ASSERT_EQ(every_table[0].table, "U");
+
+		{
+				handler::Transaction transaction(MemoryHandler);
+				ASSERT_EQ(MemoryHandler.insertRecords("T", {{"1"}, {"2"}, {"3"}}), EXIT_SUCCESS);
+				ASSERT_EQ(MemoryHandler.executeQuery("UPDATE T SET A = 5 WHERE A = 2;"), EXIT_SUCCESS);
+				ASSERT_TRUE(changes.empty());
+		}
+		ASSERT_EQ(changes.size(), 1u);
+		ASSERT_EQ(changes[0].table, "T");
+		ASSERT_EQ(changes[0].inserted, std::vector<int64_t>({1, 2, 3}));
+		ASSERT_EQ(changes[0].updated, std::vector<int64_t>({2}));
+		ASSERT_FALSE(changes[0].external);
+
+		/* Rolled back changes are not reported */
+		{
+				handler::Transaction transaction(MemoryHandler);
+				ASSERT_EQ(MemoryHandler.executeQuery("DELETE FROM T WHERE A = 1;"), EXIT_SUCCESS);
+				ASSERT_EQ(transaction.rollback(), EXIT_SUCCESS);
+		}
+		ASSERT_EQ(changes.size(), 1u);
+
+		ASSERT_EQ(MemoryHandler.executeQuery("DELETE FROM T WHERE A = 1;"), EXIT_SUCCESS);
+		ASSERT_EQ(changes.size(), 2u);
+		ASSERT_EQ(changes[1].deleted, std::vector<int64_t>({1}));
+
+		ASSERT_EQ(MemoryHandler.removeTableListener(id), EXIT_SUCCESS);
+		ASSERT_EQ(MemoryHandler.removeTableListener(id), EXIT_FAILURE);
+		ASSERT_EQ(MemoryHandler.executeQuery("DELETE FROM T WHERE A = 3;"), EXIT_SUCCESS);
+		ASSERT_EQ(changes.size(), 2u);
+		ASSERT_EQ(every_table.size(), 4u);
+}
+
+/* Commits of other connections are noticed through the data version */
+TEST(Table_Changes, Polls_Changes_Of_Other_Connections){
+		std::remove("ChangesDB.db");
+		{
+				handler::Sqlite3Db Listener("ChangesDB.db");
+				ASSERT_EQ(Listener.createTable("T", {{"A", "INT"}}), EXIT_SUCCESS);
+				handler::Sqlite3Db Writer("ChangesDB.db");
+				std::vector<handler::TableChange> changes;
+
+				Listener.onTableChanged("T", [&changes](const handler::TableChange &change) {
+						changes.push_back(change);
+				});
+				ASSERT_EQ(Listener.pollExternalChanges(), EXIT_SUCCESS);
+				ASSERT_TRUE(changes.empty());
+
+				ASSERT_EQ(Writer.insertRecord("T", {"1"}), EXIT_SUCCESS);
+				ASSERT_EQ(Listener.pollExternalChanges(), EXIT_SUCCESS);
+				ASSERT_EQ(changes.size(), 1u);
+				ASSERT_TRUE(changes[0].external);
+				ASSERT_EQ(changes[0].table, "T");
+				ASSERT_TRUE(changes[0].inserted.empty());
+
+				ASSERT_EQ(Listener.pollExternalChanges(), EXIT_SUCCESS);
+				ASSERT_EQ(changes.size(), 1u);
+
+				/* Changes of the connection itself come from its hooks */
+				ASSERT_EQ(Listener.insertRecord("T", {"2"}), EXIT_SUCCESS);
+				ASSERT_EQ(changes.size(), 2u);
+				ASSERT_FALSE(changes[1].external);
+				ASSERT_EQ(Listener.pollExternalChanges(), EXIT_SUCCESS);
+				ASSERT_EQ(changes.size(), 2u);
+		}
+		std::remove("ChangesDB.db");
+}
+
+/* Listeners are called once the commit is done, so other connections see the rows */
+TEST(Table_Changes, Listeners_Read_Committed_Rows_From_Other_Connections){
+		std::remove("ChangesReadDB.db");
+		{
+				handler::Sqlite3Db Writer("ChangesReadDB.db");
+				ASSERT_EQ(Writer.createTable("T", {{"A", "INT"}}), EXIT_SUCCESS);
+				handler::Sqlite3Db Reader("ChangesReadDB.db");
+				std::vector<std::string> counts;
+
+				Writer.onTableChanged("T", [&Reader, &counts](const handler::TableChange&) {
+						std::vector<std::string> data;
+						ASSERT_EQ(Reader.executeQuery("SELECT COUNT(*) FROM T;", data, {0}), EXIT_SUCCESS);
+						counts.insert(counts.end(), data.begin(), data.end());
+				});
+
+				ASSERT_EQ(Writer.insertRecord("T", {"1"}), EXIT_SUCCESS);
+				ASSERT_EQ(counts, std::vector<std::string>({"1"}));
+				{
+						handler::Transaction transaction(Writer);
+						ASSERT_EQ(Writer.insertRecords("T", {{"2"}, {"3"}}), EXIT_SUCCESS);
+						ASSERT_EQ(transaction.commit(), EXIT_SUCCESS);
+				}
+				ASSERT_EQ(counts, std::vector<std::string>({"1", "3"}));
+
+				handler::PreparedQuery insert = Writer.prepare("INSERT INTO T VALUES (?1);");
+				ASSERT_EQ(insert.bind(1, 4), EXIT_SUCCESS);
+				ASSERT_FALSE(insert.step());
+				ASSERT_EQ(counts, std::vector<std::string>({"1", "3", "4"}));
+		}
+		std::remove("ChangesReadDB.db");
+}
+
 /*******************DISCONNECTION AND CONNECTION**************************/
 /* Disconnecting from the db causes no exceptions or errors */
 TEST(Connection_Operations, Succeeds_Disconnect_From_DB){